@@ -0,0 +1,157 @@
+// batch_eval.h
+// Rules for many independent 3x3 positions at once.
+//
+// Positions come in structure-of-arrays form: one array of X masks and one
+// of O masks (GameState::x / ::o, bit i = cell i). For every position the
+// batch computes what GameState::result() does, 0 still playing, 1 X wins,
+// -1 O wins, 2 draw, plus the legal moves (empty cells, none once the game
+// is over).
+//
+// Each mask is 16 bits, so one SSE2 register holds 8 positions and one
+// AVX2 register 16; the line test is a dozen shifts and ANDs for the
+// whole register, with no branches and no table lookups. The tail
+// that does not fill a register goes through the scalar version, which is
+// also the fallback on other CPUs. bestBatchIsa() picks the widest
+// instruction set the CPU supports at run time, so the program itself
+// builds without -mavx2.
+//
+// No GLFW / OpenGL dependency.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "game_state.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BATCH_EVAL_X86 1
+#include <immintrin.h>
+#endif
+
+enum BatchIsa { BATCH_SCALAR, BATCH_SSE2, BATCH_AVX2 };
+
+inline const char* batchIsaName(BatchIsa isa) {
+    switch(isa) {
+        case BATCH_SSE2: return "sse2";
+        case BATCH_AVX2: return "avx2";
+        default:         return "scalar";
+    }
+}
+
+// n positions from x[] / o[]; result[] gets GameState::result(), legal[] the empty cells while playing
+inline void evaluateBatchScalar(const uint16_t* x, const uint16_t* o, size_t n, int8_t* result, uint16_t* legal) {
+    for(size_t i=0;i<n;i++){
+        int xWins = WIN_LINE_TABLE.line[x[i] & FULL_BOARD] >= 0;
+        int oWins = !xWins & (WIN_LINE_TABLE.line[o[i] & FULL_BOARD] >= 0);
+        uint16_t empty = (uint16_t)(~(x[i] | o[i]) & FULL_BOARD);
+        int over = xWins | oWins;
+        result[i] = (int8_t)(xWins - oWins + 2 * (!over & (empty == 0)));
+        legal[i] = over ? 0 : empty;
+    }
+}
+
+#ifdef BATCH_EVAL_X86
+
+namespace batch_detail {
+
+// All ones in the lanes whose 9-bit mask holds a line. Shifting the mask
+// right by the step between a line's cells lines them up on its first cell:
+//   rows      m & m>>1 & m>>2 at bits 0, 3, 6
+//   columns   m & m>>3 & m>>6 at bits 0, 1, 2
+//   diagonals m & m>>4 & m>>8 and m>>2 & m>>4 & m>>6 at bit 0
+// which is half the work of comparing against the 8 line masks one by one.
+__attribute__((target("sse2")))
+inline __m128i anyLine(__m128i m) {
+    __m128i s2 = _mm_srli_epi16(m, 2), s4 = _mm_srli_epi16(m, 4), s6 = _mm_srli_epi16(m, 6);
+    __m128i rows = _mm_and_si128(_mm_and_si128(m, _mm_srli_epi16(m, 1)), _mm_and_si128(s2, _mm_set1_epi16(0x49)));
+    __m128i cols = _mm_and_si128(_mm_and_si128(m, _mm_srli_epi16(m, 3)), _mm_and_si128(s6, _mm_set1_epi16(0x7)));
+    __m128i diagonals = _mm_or_si128(_mm_and_si128(_mm_and_si128(m, s4), _mm_srli_epi16(m, 8)), _mm_and_si128(_mm_and_si128(s2, s4), s6));
+    __m128i bits = _mm_or_si128(_mm_or_si128(rows, cols), _mm_and_si128(diagonals, _mm_set1_epi16(1)));
+    return _mm_xor_si128(_mm_cmpeq_epi16(bits, _mm_setzero_si128()), _mm_set1_epi16(-1));
+}
+
+// the same on 16 lanes
+__attribute__((target("avx2")))
+inline __m256i anyLine(__m256i m) {
+    __m256i s2 = _mm256_srli_epi16(m, 2), s4 = _mm256_srli_epi16(m, 4), s6 = _mm256_srli_epi16(m, 6);
+    __m256i rows = _mm256_and_si256(_mm256_and_si256(m, _mm256_srli_epi16(m, 1)), _mm256_and_si256(s2, _mm256_set1_epi16(0x49)));
+    __m256i cols = _mm256_and_si256(_mm256_and_si256(m, _mm256_srli_epi16(m, 3)), _mm256_and_si256(s6, _mm256_set1_epi16(0x7)));
+    __m256i diagonals = _mm256_or_si256(_mm256_and_si256(_mm256_and_si256(m, s4), _mm256_srli_epi16(m, 8)), _mm256_and_si256(_mm256_and_si256(s2, s4), s6));
+    __m256i bits = _mm256_or_si256(_mm256_or_si256(rows, cols), _mm256_and_si256(diagonals, _mm256_set1_epi16(1)));
+    return _mm256_xor_si256(_mm256_cmpeq_epi16(bits, _mm256_setzero_si256()), _mm256_set1_epi16(-1));
+}
+
+} // namespace batch_detail
+
+// SSE2 is part of x86-64, so this one needs no run-time check there
+__attribute__((target("sse2")))
+inline void evaluateBatchSse2(const uint16_t* x, const uint16_t* o, size_t n, int8_t* result, uint16_t* legal) {
+    using namespace batch_detail;
+    const __m128i full = _mm_set1_epi16((short)FULL_BOARD);
+    const __m128i one = _mm_set1_epi16(1), two = _mm_set1_epi16(2);
+    size_t i = 0;
+    for(;i+8<=n;i+=8){
+        __m128i xv = _mm_and_si128(_mm_loadu_si128((const __m128i*)(x + i)), full);
+        __m128i ov = _mm_and_si128(_mm_loadu_si128((const __m128i*)(o + i)), full);
+        __m128i xWins = anyLine(xv);
+        __m128i oWins = _mm_andnot_si128(xWins, anyLine(ov));
+        __m128i over = _mm_or_si128(xWins, oWins);
+        __m128i empty = _mm_andnot_si128(_mm_or_si128(xv, ov), full);
+        __m128i draw = _mm_andnot_si128(over, _mm_cmpeq_epi16(empty, _mm_setzero_si128()));
+        // 1 / -1 (all ones) / 2 / 0 per lane
+        __m128i res = _mm_or_si128(_mm_or_si128(_mm_and_si128(xWins, one), oWins), _mm_and_si128(draw, two));
+        _mm_storel_epi64((__m128i*)(result + i), _mm_packs_epi16(res, res));
+        _mm_storeu_si128((__m128i*)(legal + i), _mm_andnot_si128(over, empty));
+    }
+    evaluateBatchScalar(x + i, o + i, n - i, result + i, legal + i);
+}
+
+__attribute__((target("avx2")))
+inline void evaluateBatchAvx2(const uint16_t* x, const uint16_t* o, size_t n, int8_t* result, uint16_t* legal) {
+    using namespace batch_detail;
+    const __m256i full = _mm256_set1_epi16((short)FULL_BOARD);
+    const __m256i one = _mm256_set1_epi16(1), two = _mm256_set1_epi16(2);
+    size_t i = 0;
+    for(;i+16<=n;i+=16){
+        __m256i xv = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(x + i)), full);
+        __m256i ov = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(o + i)), full);
+        __m256i xWins = anyLine(xv);
+        __m256i oWins = _mm256_andnot_si256(xWins, anyLine(ov));
+        __m256i over = _mm256_or_si256(xWins, oWins);
+        __m256i empty = _mm256_andnot_si256(_mm256_or_si256(xv, ov), full);
+        __m256i draw = _mm256_andnot_si256(over, _mm256_cmpeq_epi16(empty, _mm256_setzero_si256()));
+        __m256i res = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(xWins, one), oWins), _mm256_and_si256(draw, two));
+        // packs works per 128-bit half, so pack the two halves against each other
+        __m128i bytes = _mm_packs_epi16(_mm256_castsi256_si128(res), _mm256_extracti128_si256(res, 1));
+        _mm_storeu_si128((__m128i*)(result + i), bytes);
+        _mm256_storeu_si256((__m256i*)(legal + i), _mm256_andnot_si256(over, empty));
+    }
+    evaluateBatchSse2(x + i, o + i, n - i, result + i, legal + i);
+}
+
+#endif // BATCH_EVAL_X86
+
+// widest instruction set this CPU runs
+inline BatchIsa bestBatchIsa() {
+#ifdef BATCH_EVAL_X86
+    static const BatchIsa best = __builtin_cpu_supports("avx2") ? BATCH_AVX2
+                               : __builtin_cpu_supports("sse2") ? BATCH_SSE2 : BATCH_SCALAR;
+    return best;
+#else
+    return BATCH_SCALAR;
+#endif
+}
+
+// isa must not be wider than bestBatchIsa()
+inline void evaluateBatch(BatchIsa isa, const uint16_t* x, const uint16_t* o, size_t n, int8_t* result, uint16_t* legal) {
+#ifdef BATCH_EVAL_X86
+    if(isa == BATCH_AVX2) { evaluateBatchAvx2(x, o, n, result, legal); return; }
+    if(isa == BATCH_SSE2) { evaluateBatchSse2(x, o, n, result, legal); return; }
+#endif
+    evaluateBatchScalar(x, o, n, result, legal);
+}
+
+inline void evaluateBatch(const uint16_t* x, const uint16_t* o, size_t n, int8_t* result, uint16_t* legal) {
+    evaluateBatch(bestBatchIsa(), x, o, n, result, legal);
+}
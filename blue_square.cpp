@@ -2,6 +2,8 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 
+#include "shader_cache.h"
+
 // Vertex data for a blue square (position + color)
 float vertices[] = {
     // positions       // colors
@@ -50,7 +52,12 @@ int main() {
     }
 
     glfwMakeContextCurrent(window);
-    glewInit();
+    glewExperimental = GL_TRUE;
+    if(glewInit() != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW\n";
+        glfwTerminate();
+        return -1;
+    }
 
     unsigned int VAO, VBO, EBO;
     glGenVertexArrays(1, &VAO);
@@ -72,22 +79,12 @@ int main() {
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(float), (void*)(3*sizeof(float)));
     glEnableVertexAttribArray(1);
 
-    // compile shaders
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    // compile shaders (errors are printed; the linked binary is cached on disk)
+    unsigned int shaderProgram = shaderCache().loadSource(vertexShaderSource, fragmentShaderSource);
+    if(shaderProgram == 0) {
+        glfwTerminate();
+        return -1;
+    }
 
     while(!glfwWindowShouldClose(window)) {
         glClearColor(0.8f,0.8f,0.8f,1.0f);
@@ -104,6 +101,7 @@ int main() {
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
+    shaderCache().clear();
     glfwTerminate();
     return 0;
 }
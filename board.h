@@ -0,0 +1,116 @@
+// board.h
+// Generalized m,n,k board: width x height cells, k in a row wins.
+//
+// The classic game is Board(3,3,3); gomoku-style variants are e.g.
+// Board(15,15,5) or Board(19,19,5). Win detection only walks the four
+// directions through the stone that was just placed, so each move costs
+// O(k) no matter how large the board is.
+//
+// Cells use the same values as main.cpp: 0 empty, 1 = X, -1 = O.
+// No GLFW / OpenGL dependency.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "game_state.h"
+
+class Board {
+public:
+    Board(int width = 3, int height = 3, int k = 3)
+        : w(width), h(height), k(k), cells(width * height, 0) {
+        reset();
+    }
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int inARow() const { return k; }
+    int size() const { return w * h; }
+    bool isClassic() const { return w == 3 && h == 3 && k == 3; }
+
+    int at(int idx) const { return cells[idx]; }
+    int at(int row, int col) const { return cells[row * w + col]; }
+    bool isEmpty(int idx) const { return cells[idx] == 0; }
+    int moveCount() const { return filled; }
+    int lastMove() const { return last; }
+
+    // 1 => X, -1 => O (X always moves first)
+    int sideToMove() const { return (filled & 1) ? -1 : 1; }
+
+    void reset() {
+        for(int i=0;i<size();i++) cells[i] = 0;
+        filled = 0;
+        last = -1;
+        state = 0;
+        lineFrom = lineTo = -1;
+    }
+
+    // 0 still playing, 1 X wins, -1 O wins, 2 draw
+    int result() const { return state; }
+
+    // place player's stone on an empty cell and return result()
+    int play(int idx, int player) {
+        cells[idx] = (int8_t)player;
+        filled++;
+        last = idx;
+        if(completesLine(idx, player)) state = player;
+        else if(filled == size()) state = 2;
+        return state;
+    }
+
+    // end cells of the winning run, false if nobody has won
+    bool winningLine(int& from, int& to) const {
+        if(lineFrom < 0) return false;
+        from = lineFrom;
+        to = lineTo;
+        return true;
+    }
+
+private:
+    int w, h, k;
+    std::vector<int8_t> cells;
+    int filled;
+    int last;
+    int state;
+    int lineFrom, lineTo;
+
+    // length of the run of player's stones starting next to (r,c) in direction (dr,dc)
+    int run(int r, int c, int dr, int dc, int player, int& endR, int& endC) const {
+        int n = 0;
+        endR = r; endC = c;
+        for(;;){
+            r += dr; c += dc;
+            if(r < 0 || r >= h || c < 0 || c >= w || cells[r * w + c] != player) break;
+            endR = r; endC = c;
+            n++;
+        }
+        return n;
+    }
+
+    bool completesLine(int idx, int player) {
+        static const int DIRS[4][2] = {{0,1},{1,0},{1,1},{1,-1}};
+        int r = idx / w, c = idx % w;
+        for(int d=0;d<4;d++){
+            int r1, c1, r2, c2;
+            int n = 1 + run(r, c, DIRS[d][0], DIRS[d][1], player, r1, c1)
+                      + run(r, c, -DIRS[d][0], -DIRS[d][1], player, r2, c2);
+            if(n >= k) {
+                lineFrom = r2 * w + c2;
+                lineTo = r1 * w + c1;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// bitboard copy of a classic 3x3 board for the table / solver
+inline GameState toGameState(const Board& b) {
+    GameState s;
+    for(int i=0;i<9;i++){
+        if(b.at(i) == 1) s.x |= (uint16_t)(1u << i);
+        else if(b.at(i) == -1) s.o |= (uint16_t)(1u << i);
+    }
+    return s;
+}
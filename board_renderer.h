@@ -0,0 +1,299 @@
+// board_renderer.h
+// Core-profile renderer for the Three-in-a-Row board (main.cpp).
+//
+// Every frame is submitted in two draw calls:
+//  1. the board: one quad per cell, instanced, with the cell contents
+//     (empty / X / O) and the heatmap value as per-instance data. The
+//     fragment shader (shaders/board_sdf.*) draws the grid lines, the X
+//     and O, the heatmap, the hint, the game-over shade and the winning
+//     strike from signed distance functions in pixels, so edges are
+//     anti-aliased and stay sharp at any window size, and the vertex
+//     count is 4 per cell no matter how large the window is.
+//  2. a batch of flat colored triangles for the HUD (shaders/board.*).
+//
+// drawBoardFrame() is the whole frame as main.cpp draws it (viewport,
+// background, board); golden_check and render_bench call it too, so they
+// see what the window shows.
+//
+// Include this after the OpenGL loader.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+#include "profiler.h"
+#include "shader_cache.h"
+
+// what to draw; filled in by the game every frame
+struct BoardScene {
+    const Board* board = nullptr;
+    int currentPlayer = 1; // 1 => X, -1 => O
+    bool gameOver = false;
+    int winner = 0;        // 0 none, 1 X, -1 O, 2 draw
+    int hintCell = -1;     // cell to highlight, -1 for none
+    const float* heat = nullptr; // per cell 0 (loss) .. 1 (win) for the side to move, < 0 none; nullptr for no heatmap
+    uint64_t heatVersion = 0;    // must change whenever the heat values do
+};
+
+class BoardRenderer {
+public:
+    bool init(const std::string& vertexPath = "shaders/board_sdf.vert",
+              const std::string& fragmentPath = "shaders/board_sdf.frag",
+              const std::string& batchVertexPath = "shaders/board.vert",
+              const std::string& batchFragmentPath = "shaders/board.frag") {
+        PROFILE_ZONE("BoardRenderer::init");
+        cellProgram = shaderCache().load(vertexPath, fragmentPath);
+        batchProgram = shaderCache().load(batchVertexPath, batchFragmentPath);
+        if(cellProgram == 0 || batchProgram == 0) return false;
+
+        glGenVertexArrays(1, &cellVAO);
+        glGenVertexArrays(1, &batchVAO);
+        glGenBuffers(1, &quadVBO);
+        glGenBuffers(1, &kindVBO);
+        glGenBuffers(1, &heatVBO);
+        glGenBuffers(1, &batchVBO);
+
+        // unit quad as a triangle strip, shared by every cell
+        const float quad[8] = {0,0, 1,0, 0,1, 1,1};
+        glBindVertexArray(cellVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+        glEnableVertexAttribArray(0);
+
+        // one signed byte per cell, converted to float by the attribute
+        glBindBuffer(GL_ARRAY_BUFFER, kindVBO);
+        glVertexAttribPointer(1, 1, GL_BYTE, GL_FALSE, 1, (void*)0);
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(1);
+
+        // heat: one byte per cell, 0 = none, 1..255 => 0..1
+        glBindBuffer(GL_ARRAY_BUFFER, heatVBO);
+        glVertexAttribPointer(2, 1, GL_UNSIGNED_BYTE, GL_FALSE, 1, (void*)0);
+        glVertexAttribDivisor(2, 1);
+        glEnableVertexAttribArray(2);
+
+        glBindVertexArray(batchVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, batchVBO);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, pos));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+        glEnableVertexAttribArray(1);
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        return true;
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &quadVBO);
+        glDeleteBuffers(1, &kindVBO);
+        glDeleteBuffers(1, &heatVBO);
+        glDeleteBuffers(1, &batchVBO);
+        glDeleteVertexArrays(1, &cellVAO);
+        glDeleteVertexArrays(1, &batchVAO);
+        cellProgram = batchProgram = 0; // owned by shaderCache()
+    }
+
+    void render(const BoardScene& scene, int fbW, int fbH) {
+        PROFILE_ZONE("BoardRenderer::render");
+        const Board& b = *scene.board;
+        fbWidth = fbW > 0 ? fbW : 1;
+        fbHeight = fbH > 0 ? fbH : 1;
+        if(b.size() != uploadedCells || b.moveCount() != uploadedMoves || b.lastMove() != uploadedLast) uploadCells(b);
+        uint64_t heatVersion = scene.heat ? scene.heatVersion : 0;
+        if(b.size() != uploadedHeatCells || heatVersion != uploadedHeat) uploadHeat(b, scene.heat, heatVersion);
+        buildBatch(scene);
+
+        glEnable(GL_BLEND);
+
+        // 1. cells (the shader outputs premultiplied alpha)
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glUseProgram(cellProgram);
+        setCellUniforms(scene);
+        glBindVertexArray(cellVAO);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)b.size());
+
+        // 2. HUD
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glUseProgram(batchProgram);
+        glBindVertexArray(batchVAO);
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)batch.size());
+        lastDrawCalls = 2;
+        lastVertices = 4 * (size_t)b.size() + batch.size();
+
+        glBindVertexArray(0);
+        glUseProgram(0);
+        glDisable(GL_BLEND);
+    }
+
+    // draw calls issued by the last render()
+    size_t drawCalls() const { return lastDrawCalls; }
+    // vertices submitted by the last render()
+    size_t vertexCount() const { return lastVertices; }
+
+private:
+    struct Vertex {
+        float pos[2];
+        float color[4];
+    };
+
+    static constexpr float PIECE_SIZE = 0.28f;    // X half extent / O radius, fraction of the cell
+    static constexpr float PIECE_STROKE = 0.072f; // half stroke width, fraction of the piece size
+
+    GLuint cellProgram = 0, batchProgram = 0;
+    GLuint cellVAO = 0, batchVAO = 0;
+    GLuint quadVBO = 0, kindVBO = 0, heatVBO = 0, batchVBO = 0;
+
+    std::vector<int8_t> kinds;   // per cell: 0, 1 = X, -1 = O
+    size_t kindCapacity = 0;     // cells allocated in kindVBO
+    std::vector<uint8_t> heats;  // per cell: 0 none, 1..255
+    size_t heatCapacity = 0;     // cells allocated in heatVBO
+    std::vector<Vertex> batch;
+    size_t batchCapacity = 0;    // vertices allocated in batchVBO
+    size_t lastDrawCalls = 0, lastVertices = 0;
+
+    int uploadedCells = -1, uploadedMoves = -1, uploadedLast = -2;
+    int uploadedHeatCells = -1;
+    uint64_t uploadedHeat = 0;
+    int fbWidth = 1, fbHeight = 1;
+
+    // thinner strokes on bigger boards so pieces don't merge
+    static float strokeScale(const Board& b) {
+        int n = b.width() > b.height() ? b.width() : b.height();
+        float s = 3.0f / n;
+        return s < 0.25f ? 0.25f : s;
+    }
+
+    float cellPixelsX(const Board& b) const { return (float)fbWidth / b.width(); }
+    float cellPixelsY(const Board& b) const { return (float)fbHeight / b.height(); }
+
+    // cell center in window pixels (gl_FragCoord: origin bottom-left)
+    void cellCenterPixels(const Board& b, int idx, float& x, float& y) const {
+        x = (idx % b.width() + 0.5f) * cellPixelsX(b);
+        y = fbHeight - (idx / b.width() + 0.5f) * cellPixelsY(b);
+    }
+
+    void uploadCells(const Board& b) {
+        PROFILE_ZONE("BoardRenderer::uploadCells");
+        uploadedCells = b.size();
+        uploadedMoves = b.moveCount();
+        uploadedLast = b.lastMove();
+
+        kinds.resize(b.size());
+        for(int i=0;i<b.size();i++) kinds[i] = (int8_t)b.at(i);
+
+        glBindBuffer(GL_ARRAY_BUFFER, kindVBO);
+        if(kinds.size() > kindCapacity) {
+            kindCapacity = kinds.size();
+            glBufferData(GL_ARRAY_BUFFER, kindCapacity, NULL, GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, 0, kinds.size(), kinds.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // a new heatmap is one small buffer update; the shader picks the colors
+    void uploadHeat(const Board& b, const float* heat, uint64_t version) {
+        PROFILE_ZONE("BoardRenderer::uploadHeat");
+        uploadedHeatCells = b.size();
+        uploadedHeat = version;
+
+        heats.assign(b.size(), 0);
+        for(int i=0;heat && i<b.size();i++){
+            if(heat[i] < 0.0f) continue;
+            float v = heat[i] > 1.0f ? 1.0f : heat[i];
+            heats[i] = (uint8_t)(1.5f + v * 254.0f);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, heatVBO);
+        if(heats.size() > heatCapacity) {
+            heatCapacity = heats.size();
+            glBufferData(GL_ARRAY_BUFFER, heatCapacity, NULL, GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, 0, heats.size(), heats.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    GLint uniform(const char* name) const { return shaderCache().uniform(cellProgram, name); }
+
+    void setCellUniforms(const BoardScene& scene) const {
+        const Board& b = *scene.board;
+        float cw = cellPixelsX(b), ch = cellPixelsY(b);
+        float pieceRadius = PIECE_SIZE * (cw < ch ? cw : ch);
+
+        glUniform2i(uniform("gridSize"), b.width(), b.height());
+        glUniform2f(uniform("cellPixels"), cw, ch);
+        glUniform1f(uniform("gridHalfWidth"), 4.0f * strokeScale(b));
+        glUniform1f(uniform("pieceRadius"), pieceRadius);
+        glUniform1f(uniform("pieceHalfWidth"), PIECE_STROKE * pieceRadius);
+        glUniform4f(uniform("gridColor"), 0.15f, 0.15f, 0.15f, 1.0f);
+        glUniform4f(uniform("xColor"), 0.9f, 0.2f, 0.2f, 1.0f);
+        glUniform4f(uniform("oColor"), 0.12f, 0.2f, 0.9f, 1.0f);
+        glUniform1i(uniform("hintCell"), scene.gameOver ? -1 : scene.hintCell);
+        glUniform4f(uniform("hintColor"), 0.2f, 0.8f, 0.3f, 0.25f);
+        glUniform1f(uniform("heatAlpha"), scene.gameOver ? 0.0f : 0.4f);
+        glUniform3f(uniform("heatLoss"), 0.85f, 0.15f, 0.1f);
+        glUniform3f(uniform("heatDraw"), 0.95f, 0.8f, 0.2f);
+        glUniform3f(uniform("heatWin"), 0.1f, 0.75f, 0.25f);
+        glUniform1f(uniform("shade"), scene.gameOver ? 0.35f : 0.0f);
+
+        // a thicker colored line across the centers of the winning run
+        int from, to;
+        if(scene.gameOver && (scene.winner == 1 || scene.winner == -1) && b.winningLine(from, to)) {
+            float x1, y1, x2, y2;
+            cellCenterPixels(b, from, x1, y1);
+            cellCenterPixels(b, to, x2, y2);
+            glUniform4f(uniform("strike"), x1, y1, x2, y2);
+            glUniform1f(uniform("strikeHalfWidth"), 5.0f * strokeScale(b));
+            if(scene.winner == 1) glUniform4f(uniform("strikeColor"), 1.0f, 0.7f, 0.2f, 1.0f);
+            else                  glUniform4f(uniform("strikeColor"), 0.2f, 0.9f, 0.7f, 1.0f);
+        } else {
+            glUniform1f(uniform("strikeHalfWidth"), 0.0f);
+        }
+    }
+
+    void addQuad(float x0, float y0, float x1, float y1, const float c[4]) {
+        Vertex v[4] = {
+            {{x0,y0},{c[0],c[1],c[2],c[3]}}, {{x1,y0},{c[0],c[1],c[2],c[3]}},
+            {{x1,y1},{c[0],c[1],c[2],c[3]}}, {{x0,y1},{c[0],c[1],c[2],c[3]}}
+        };
+        const int order[6] = {0,1,2, 0,2,3};
+        for(int i : order) batch.push_back(v[i]);
+    }
+
+    // HUD: small square top-left, whose turn it is or who won
+    void buildBatch(const BoardScene& scene) {
+        PROFILE_ZONE("BoardRenderer::buildBatch");
+        batch.clear();
+        float hud[4] = {0, 0, 0, 1};
+        if(!scene.gameOver) {
+            if(scene.currentPlayer == 1) { hud[0] = 0.9f;  hud[1] = 0.2f; hud[2] = 0.2f; }
+            else                         { hud[0] = 0.12f; hud[1] = 0.2f; hud[2] = 0.9f; }
+        } else if(scene.winner == 2) { hud[0] = 0.4f; hud[1] = 0.5f; hud[2] = 0.4f; } // draw color
+        else if(scene.winner == 1)   { hud[0] = 1.0f; hud[1] = 0.7f; hud[2] = 0.2f; }
+        else                         { hud[0] = 0.2f; hud[1] = 0.9f; hud[2] = 0.7f; }
+        addQuad(-0.98f, 0.92f, -0.88f, 0.82f, hud);
+
+        glBindBuffer(GL_ARRAY_BUFFER, batchVBO);
+        if(batch.size() > batchCapacity) {
+            batchCapacity = batch.capacity();
+            glBufferData(GL_ARRAY_BUFFER, batchCapacity * sizeof(Vertex), NULL, GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, 0, batch.size() * sizeof(Vertex), batch.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+};
+
+const float BOARD_BACKGROUND[4] = {0.95f, 0.95f, 0.95f, 1.0f};
+
+// one frame of the board window, before any overlay
+inline void drawBoardFrame(BoardRenderer& renderer, const BoardScene& scene, int fbW, int fbH) {
+    glViewport(0, 0, fbW, fbH);
+    glClearColor(BOARD_BACKGROUND[0], BOARD_BACKGROUND[1], BOARD_BACKGROUND[2], BOARD_BACKGROUND[3]);
+    glClear(GL_COLOR_BUFFER_BIT);
+    renderer.render(scene, fbW, fbH);
+}
@@ -0,0 +1,67 @@
+// board_scenes.h
+// Fixed Three-in-a-Row positions covering every state the board renderer
+// draws (empty, in play, hint, heatmap, X / O wins, draw, large boards), shared by
+// the offscreen tools render_bench.cpp and golden_check.cpp.
+//
+// Include this after the OpenGL loader (it needs BoardScene).
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "board_renderer.h"
+#include "heatmap.h"
+#include "rng.h"
+
+struct BoardSceneCase {
+    std::string name;
+    int width, height, k;
+    std::vector<int> moves;  // played in order, X first
+    int hintCell;            // -1 for none
+    int randomMoves;         // then this many random moves (stops at a win)
+    uint64_t seed;
+    bool heatmap = false;    // exact 3x3 heatmap (heatmap.h) for the side to move
+};
+
+inline const std::vector<BoardSceneCase>& boardSceneCases() {
+    static const std::vector<BoardSceneCase> cases = {
+        {"board 3x3 empty",     3, 3, 3, {},                          -1, 0, 0},
+        {"board 3x3 playing",   3, 3, 3, {4, 0, 2},                   -1, 0, 0},
+        {"board 3x3 hint",      3, 3, 3, {4, 0, 2},                    6, 0, 0},
+        {"board 3x3 heatmap",   3, 3, 3, {4, 1},                      -1, 0, 0, true},
+        {"board 3x3 X wins",    3, 3, 3, {4, 0, 2, 1, 6},             -1, 0, 0},
+        {"board 3x3 O wins",    3, 3, 3, {0, 4, 1, 2, 8, 6},          -1, 0, 0},
+        {"board 3x3 draw",      3, 3, 3, {0, 1, 2, 4, 3, 5, 7, 6, 8}, -1, 0, 0},
+        {"board 15x15 midgame", 15, 15, 5, {},                        -1, 60, 1},
+        {"board 19x19 crowded", 19, 19, 5, {},                        -1, 250, 2},
+    };
+    return cases;
+}
+
+// sets up `board` and fills in `scene` the way main.cpp does
+inline void loadBoardSceneCase(const BoardSceneCase& c, Board& board, BoardScene& scene) {
+    board = Board(c.width, c.height, c.k);
+    for(int m : c.moves) board.play(m, board.sideToMove());
+    Rng rng(c.seed);
+    for(int n=0;n<c.randomMoves && board.result() == 0;){
+        int idx = (int)rng.below((uint32_t)board.size());
+        if(!board.isEmpty(idx)) continue;
+        board.play(idx, board.sideToMove());
+        n++;
+    }
+    scene.board = &board;
+    scene.currentPlayer = board.sideToMove();
+    scene.gameOver = board.result() != 0;
+    scene.winner = board.result();
+    scene.hintCell = c.hintCell;
+    static float heat[9]; // the scene only points at it
+    scene.heat = nullptr;
+    if(c.heatmap && board.isClassic()) {
+        tableHeatmap(toGameState(board), heat);
+        scene.heat = heat;
+        scene.heatVersion++;
+    }
+}
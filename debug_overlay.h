@@ -0,0 +1,166 @@
+// debug_overlay.h
+// In-window debug text (frame times, draw counts) for the core-profile
+// programs. Text uses a built-in 3x5 bitmap font: every lit font pixel
+// becomes a small quad, and all quads plus a dark backing panel go out in
+// one draw call through the flat-color HUD shaders (shaders/board.*).
+// Letters are drawn in upper case; characters without a glyph are left
+// blank.
+//
+// Include this after the OpenGL loader.
+
+#pragma once
+
+#include <cctype>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "profiler.h"
+#include "shader_cache.h"
+
+// 5 rows of 3 pixels, top row first, '1' = lit
+inline const char* overlayGlyph(char c) {
+    switch(toupper((unsigned char)c)) {
+    case '0': return "111101101101111";
+    case '1': return "010110010010111";
+    case '2': return "111001111100111";
+    case '3': return "111001111001111";
+    case '4': return "101101111001001";
+    case '5': return "111100111001111";
+    case '6': return "111100111101111";
+    case '7': return "111001001001001";
+    case '8': return "111101111101111";
+    case '9': return "111101111001111";
+    case '.': return "000000000000010";
+    case ':': return "000010000010000";
+    case '-': return "000000111000000";
+    case '/': return "001001010100100";
+    case 'A': return "010101111101101";
+    case 'B': return "110101110101110";
+    case 'C': return "011100100100011";
+    case 'D': return "110101101101110";
+    case 'E': return "111100110100111";
+    case 'F': return "111100110100100";
+    case 'G': return "011100101101011";
+    case 'H': return "101101111101101";
+    case 'I': return "111010010010111";
+    case 'J': return "001001001101010";
+    case 'K': return "101101110101101";
+    case 'L': return "100100100100111";
+    case 'M': return "101111111101101";
+    case 'N': return "110101101101101";
+    case 'O': return "010101101101010";
+    case 'P': return "110101110100100";
+    case 'Q': return "010101101110011";
+    case 'R': return "110101110101101";
+    case 'S': return "011100010001110";
+    case 'T': return "111010010010010";
+    case 'U': return "101101101101111";
+    case 'V': return "101101101101010";
+    case 'W': return "101101111111101";
+    case 'X': return "101101010101101";
+    case 'Y': return "101101010010010";
+    case 'Z': return "111001010100111";
+    default:  return nullptr;
+    }
+}
+
+class DebugOverlay {
+public:
+    bool init(const std::string& vertexPath = "shaders/board.vert",
+              const std::string& fragmentPath = "shaders/board.frag") {
+        program = shaderCache().load(vertexPath, fragmentPath);
+        if(program == 0) return false;
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, pos));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+        glEnableVertexAttribArray(1);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        return true;
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+        program = 0; // owned by shaderCache()
+    }
+
+    // lines of text in the bottom-left corner, font pixels `scale` framebuffer
+    // pixels wide
+    void draw(const std::vector<std::string>& lines, int fbW, int fbH, int scale = 2) {
+        PROFILE_ZONE("DebugOverlay::draw");
+        fbWidth = fbW > 0 ? fbW : 1;
+        fbHeight = fbH > 0 ? fbH : 1;
+        batch.clear();
+
+        size_t columns = 0;
+        for(const std::string& l : lines) columns = l.size() > columns ? l.size() : columns;
+        const int advance = 4 * scale, lineHeight = 7 * scale, margin = 2 * scale;
+        float panelW = columns * advance + 2 * margin - scale;
+        float panelH = lines.size() * lineHeight + 2 * margin - 2 * scale;
+        const float panel[4] = {0.0f, 0.0f, 0.0f, 0.6f};
+        addRect(margin, margin, panelW, panelH, panel);
+
+        const float ink[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        for(size_t i=0;i<lines.size();i++){
+            float y = margin + panelH - margin - (i + 1) * lineHeight + 2 * scale; // bottom of the line
+            for(size_t j=0;j<lines[i].size();j++){
+                const char* g = overlayGlyph(lines[i][j]);
+                if(!g) continue;
+                float x = 2 * margin + j * advance;
+                for(int p=0;p<15;p++){
+                    if(g[p] == '1') addRect(x + (p % 3) * scale, y + (4 - p / 3) * scale, scale, scale, ink);
+                }
+            }
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        if(batch.size() > capacity) {
+            capacity = batch.capacity();
+            glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Vertex), NULL, GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, 0, batch.size() * sizeof(Vertex), batch.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glUseProgram(program);
+        glBindVertexArray(vao);
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)batch.size());
+        glBindVertexArray(0);
+        glUseProgram(0);
+        glDisable(GL_BLEND);
+    }
+
+    // the overlay's own cost, for the counters
+    size_t drawCalls() const { return 1; }
+    size_t vertexCount() const { return batch.size(); }
+
+private:
+    struct Vertex {
+        float pos[2];
+        float color[4];
+    };
+
+    GLuint program = 0, vao = 0, vbo = 0;
+    std::vector<Vertex> batch;
+    size_t capacity = 0; // vertices allocated in vbo
+    int fbWidth = 1, fbHeight = 1;
+
+    // rectangle in framebuffer pixels, origin bottom-left
+    void addRect(float x, float y, float w, float h, const float c[4]) {
+        float x0 = x * 2.0f / fbWidth - 1.0f, x1 = (x + w) * 2.0f / fbWidth - 1.0f;
+        float y0 = y * 2.0f / fbHeight - 1.0f, y1 = (y + h) * 2.0f / fbHeight - 1.0f;
+        Vertex v[4] = {
+            {{x0,y0},{c[0],c[1],c[2],c[3]}}, {{x1,y0},{c[0],c[1],c[2],c[3]}},
+            {{x1,y1},{c[0],c[1],c[2],c[3]}}, {{x0,y1},{c[0],c[1],c[2],c[3]}}
+        };
+        const int order[6] = {0,1,2, 0,2,3};
+        for(int i : order) batch.push_back(v[i]);
+    }
+};
@@ -0,0 +1,253 @@
+// frame_timing.h
+// Frame pacing and per-frame timing for the GLFW loop (main.cpp):
+//
+//  - FrameLimiter caps the frame rate without burning a core: it sleeps
+//    until shortly before the deadline and spins for the rest. How early it
+//    wakes up adapts to how late the OS scheduler has been waking it.
+//  - GpuTimer measures GPU time with GL_TIME_ELAPSED queries. The queries
+//    rotate through a small ring and results are only read once available,
+//    so timing never stalls the pipeline; a result arrives a few frames
+//    after the frame it belongs to.
+//  - LatencyTracker follows an input event through the state update, the
+//    draw submission, the buffer swap and the GPU finishing the frame, and
+//    sums up where the time went.
+//  - FrameLog keeps the counters of every frame and writes them as CSV.
+//
+// Include this after the OpenGL loader (OpenGL 3.3: timer queries are core).
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "profiler.h"
+
+class FrameLimiter {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // 0 => no cap
+    void setTargetFps(double fps) {
+        targetFps = fps > 0.0 ? fps : 0.0;
+        deadline = clock::now();
+    }
+    double fps() const { return targetFps; }
+
+    // call once per frame after the buffer swap; returns when the next
+    // frame may start
+    void wait() {
+        if(targetFps <= 0.0) return;
+        PROFILE_ZONE("FrameLimiter::wait");
+        auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / targetFps));
+        auto now = clock::now();
+        deadline += period;
+        // more than a frame behind (stall, breakpoint, no redraw for a
+        // while): start over instead of rushing frames out to catch up
+        if(deadline + period < now) deadline = now;
+
+        auto sleepUntil = deadline - std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(spinSeconds));
+        if(sleepUntil > now) {
+            std::this_thread::sleep_until(sleepUntil);
+            // learn the scheduler's wake-up latency: jump up to a late
+            // wake-up right away, decay slowly otherwise
+            double late = std::chrono::duration<double>(clock::now() - sleepUntil).count();
+            spinSeconds = late * 1.5 > spinSeconds ? late * 1.5 : spinSeconds * 0.95 + late * 0.05;
+            if(spinSeconds < MIN_SPIN) spinSeconds = MIN_SPIN;
+            if(spinSeconds > MAX_SPIN) spinSeconds = MAX_SPIN;
+        }
+        while(clock::now() < deadline) std::this_thread::yield();
+    }
+
+    // current spin margin, seconds
+    double spinMargin() const { return spinSeconds; }
+
+private:
+    static constexpr double MIN_SPIN = 0.0002;
+    static constexpr double MAX_SPIN = 0.004;
+
+    double targetFps = 0.0;
+    double spinSeconds = 0.001;
+    clock::time_point deadline = clock::now();
+};
+
+class GpuTimer {
+public:
+    bool init() {
+        glGenQueries(RING, queries);
+        return glGetError() == GL_NO_ERROR;
+    }
+
+    void destroy() {
+        glDeleteQueries(RING, queries);
+        head = count = 0;
+    }
+
+    // bracket the GPU work of one frame; `frame` comes back from collect().
+    // If every query is still in flight the frame is simply not timed.
+    void begin(long frame) {
+        active = count < RING;
+        if(!active) return;
+        int slot = (head + count) % RING;
+        frames[slot] = frame;
+        glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+    }
+
+    void end() {
+        if(!active) return;
+        glEndQuery(GL_TIME_ELAPSED);
+        count++;
+        active = false;
+    }
+
+    // oldest finished measurement, if any; never blocks
+    bool collect(long& frame, double& ms) {
+        if(count == 0) return false;
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries[head], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available) return false;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[head], GL_QUERY_RESULT, &ns);
+        frame = frames[head];
+        ms = ns * 1e-6;
+        head = (head + 1) % RING;
+        count--;
+        return true;
+    }
+
+private:
+    static const int RING = 4;
+    GLuint queries[RING] = {};
+    long frames[RING] = {};
+    int head = 0, count = 0;
+    bool active = false;
+};
+
+// Input-to-display latency, in stages. Times are seconds on one clock
+// (glfwGetTime()); the input time is when the program saw the event, so
+// the OS/driver queue before that and the scanout after the GPU finished
+// are not included.
+struct LatencySample {
+    double input = 0.0;    // event handled by the program
+    double update = 0.0;   // game state changed
+    double submit = 0.0;   // all draw calls of the frame issued
+    double swap = 0.0;     // glfwSwapBuffers() returned
+    double complete = 0.0; // GPU done with the frame (fence after the swap)
+    double totalMs() const { return (complete - input) * 1000.0; }
+};
+
+class LatencyTracker {
+public:
+    // an input changed the state at `update`; the next frame shows it.
+    // Several inputs before one frame count from the first.
+    void input(double inputTime, double updateTime) {
+        if(pendingInput) return;
+        pendingInput = true;
+        current.input = inputTime;
+        current.update = updateTime;
+    }
+    bool pending() const { return pendingInput; }
+
+    // a frame has been displayed; returns true if it showed a pending input
+    bool frameDone(double submit, double swap, double complete) {
+        if(!pendingInput) return false;
+        pendingInput = false;
+        current.submit = submit;
+        current.swap = swap;
+        current.complete = complete;
+        last = current;
+        count++;
+        sumQueue += current.update - current.input;
+        sumWait += current.submit - current.update;
+        sumSwap += current.swap - current.submit;
+        sumGpu += current.complete - current.swap;
+        if(current.totalMs() > maxMs) maxMs = current.totalMs();
+        return true;
+    }
+
+    long samples() const { return count; }
+    const LatencySample& latest() const { return last; }
+
+    void print(FILE* f) const {
+        if(count == 0) return;
+        double total = sumQueue + sumWait + sumSwap + sumGpu;
+        fprintf(f, "input latency: %ld samples, mean %.2f ms (update %.2f, to submit %.2f, swap %.2f, gpu %.2f), max %.2f ms\n",
+                count, 1000.0 * total / count, 1000.0 * sumQueue / count, 1000.0 * sumWait / count,
+                1000.0 * sumSwap / count, 1000.0 * sumGpu / count, maxMs);
+    }
+
+private:
+    bool pendingInput = false;
+    LatencySample current, last;
+    long count = 0;
+    double sumQueue = 0.0, sumWait = 0.0, sumSwap = 0.0, sumGpu = 0.0; // seconds
+    double maxMs = 0.0;
+};
+
+// counters of one drawn frame
+struct FrameRecord {
+    long frame = 0;
+    double time = 0.0;      // seconds since start, at the swap
+    double frameMs = 0.0;   // since the previous swap
+    double cpuMs = 0.0;     // building and submitting the frame
+    double gpuMs = -1.0;    // GL_TIME_ELAPSED; -1 until (unless) known
+    size_t drawCalls = 0;
+    size_t vertices = 0;
+    double inputMs = -1.0;  // input-to-display latency, if the frame showed an input
+};
+
+class FrameLog {
+public:
+    explicit FrameLog(bool keep = false) : keepAll(keep) {}
+
+    void add(const FrameRecord& r) {
+        last = r;
+        if(r.frame > 0) { // the first frame has no previous swap
+            smoothFrameMs = smoothFrameMs > 0.0 ? smoothFrameMs * (1.0 - SMOOTH) + r.frameMs * SMOOTH : r.frameMs;
+        }
+        smoothCpuMs = smoothCpuMs > 0.0 ? smoothCpuMs * (1.0 - SMOOTH) + r.cpuMs * SMOOTH : r.cpuMs;
+        if(keepAll) records.push_back(r);
+    }
+
+    // GPU times come in a few frames late
+    void setGpuMs(long frame, double ms) {
+        smoothGpuMs = smoothGpuMs > 0.0 ? smoothGpuMs * (1.0 - SMOOTH) + ms * SMOOTH : ms;
+        if(last.frame == frame) last.gpuMs = ms;
+        for(size_t i=records.size();i-->0;){
+            if(records[i].frame == frame) { records[i].gpuMs = ms; break; }
+            if(records[i].frame < frame) break;
+        }
+    }
+
+    const FrameRecord& latest() const { return last; }
+    // exponential moving averages, for display
+    double frameMs() const { return smoothFrameMs; }
+    double cpuMs() const { return smoothCpuMs; }
+    double gpuMs() const { return smoothGpuMs; }
+
+    bool writeCsv(const std::string& path) const {
+        FILE* f = fopen(path.c_str(), "w");
+        if(!f) return false;
+        fprintf(f, "frame,time_s,frame_ms,cpu_ms,gpu_ms,draw_calls,vertices,input_ms\n");
+        for(const FrameRecord& r : records) {
+            fprintf(f, "%ld,%.6f,%.4f,%.4f,", r.frame, r.time, r.frameMs, r.cpuMs);
+            if(r.gpuMs >= 0.0) fprintf(f, "%.4f", r.gpuMs);
+            fprintf(f, ",%zu,%zu,", r.drawCalls, r.vertices);
+            if(r.inputMs >= 0.0) fprintf(f, "%.4f", r.inputMs);
+            fprintf(f, "\n");
+        }
+        fclose(f);
+        return true;
+    }
+
+private:
+    static constexpr double SMOOTH = 0.1;
+
+    bool keepAll;
+    std::vector<FrameRecord> records;
+    FrameRecord last;
+    double smoothFrameMs = 0.0, smoothCpuMs = 0.0, smoothGpuMs = 0.0;
+};
@@ -0,0 +1,340 @@
+// game_record.h
+// Compact append-only binary format for finished games, shared by the GUI
+// (main.cpp --record / --replay), simulator and game_server, plus a
+// memory-mapped reader for scanning very large files.
+//
+// Layout (all integers little endian):
+//   file header, 16 bytes:  "TTRC", u16 version, u16 width, u16 height,
+//                           u16 k, u8 bits per move, 3 reserved
+//   blocks, each:           16-byte header (u32 "BLK1", u32 games,
+//                           u32 data bytes, u32 FNV-1a of the data) + data
+//   a game in a block:      1 byte = result (low 2 bits: 0 unfinished,
+//                           1 X wins, 2 O wins, 3 draw) | moves << 2;
+//                           moves == 63 means a u16 count follows;
+//                           then the cells, bits-per-move each (4 up to 16
+//                           cells, 8 up to 256, else 16), low nibble first,
+//                           padded to a whole byte
+// A classic game takes 1 + ceil(moves / 2) bytes, about 5 on average.
+//
+// Writers fill a GameRecordBlock in memory and append it whole, so a crash
+// can at worst leave a truncated last block, which the reader ignores. The
+// reader maps the file, hops from block header to block header to build
+// the block index (no game is touched for that), and hands out GameViews
+// that decode moves straight from the mapping, without copying or
+// allocating per game. Blocks are independent, so scans can be split
+// across threads by block.
+//
+// POSIX (mmap). No GLFW / OpenGL dependency.
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+const uint32_t RECORD_FILE_MAGIC = 0x43525454;  // "TTRC"
+const uint32_t RECORD_BLOCK_MAGIC = 0x314B4C42; // "BLK1"
+const uint16_t RECORD_VERSION = 1;
+const size_t RECORD_HEADER_SIZE = 16;
+const size_t RECORD_BLOCK_HEADER_SIZE = 16;
+const size_t RECORD_BLOCK_TARGET = 1 << 16; // data bytes per block before it is written out
+
+inline void storeLE(unsigned char* p, uint32_t v, int bytes) {
+    for(int i=0;i<bytes;i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+inline uint32_t loadLE(const unsigned char* p, int bytes) {
+    uint32_t v = 0;
+    for(int i=0;i<bytes;i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+inline uint32_t recordChecksum(const unsigned char* p, size_t n) {
+    uint32_t h = 2166136261u;
+    for(size_t i=0;i<n;i++) { h ^= p[i]; h *= 16777619u; }
+    return h;
+}
+
+struct RecordBoard {
+    int width = 3, height = 3, k = 3;
+
+    int cells() const { return width * height; }
+    int bitsPerMove() const { return cells() <= 16 ? 4 : cells() <= 256 ? 8 : 16; }
+
+    // dimensions the format can hold and a game can be won on
+    bool valid() const {
+        return width >= 1 && height >= 1 && k >= 1 && (k <= width || k <= height) && cells() <= 65536;
+    }
+};
+
+// main.cpp / game_state.h results (0 playing, 1 X, -1 O, 2 draw) <-> 2-bit code
+inline int resultToCode(int result) { return result == 1 ? 1 : result == -1 ? 2 : result == 2 ? 3 : 0; }
+inline int codeToResult(int code) { return code == 1 ? 1 : code == 2 ? -1 : code == 3 ? 2 : 0; }
+
+// games waiting to be appended; one per writer thread
+class GameRecordBlock {
+public:
+    explicit GameRecordBlock(const RecordBoard& board = RecordBoard()) : bits(board.bitsPerMove()) {}
+
+    void add(const int* moves, int count, int result) {
+        data.push_back((unsigned char)(resultToCode(result) | (count < 63 ? count : 63) << 2));
+        if(count >= 63) { data.push_back((unsigned char)(count & 0xFF)); data.push_back((unsigned char)(count >> 8)); }
+        if(bits == 4) {
+            for(int i=0;i<count;i+=2){
+                int hi = i + 1 < count ? moves[i + 1] : 0;
+                data.push_back((unsigned char)(moves[i] | hi << 4));
+            }
+        } else {
+            for(int i=0;i<count;i++){
+                data.push_back((unsigned char)(moves[i] & 0xFF));
+                if(bits == 16) data.push_back((unsigned char)(moves[i] >> 8));
+            }
+        }
+        gameCount++;
+    }
+
+    uint32_t games() const { return gameCount; }
+    size_t bytes() const { return data.size(); }
+    bool full() const { return data.size() >= RECORD_BLOCK_TARGET; }
+    bool empty() const { return gameCount == 0; }
+    const unsigned char* bytesPtr() const { return data.data(); }
+    void clear() { data.clear(); gameCount = 0; }
+
+private:
+    int bits;
+    std::vector<unsigned char> data;
+    uint32_t gameCount = 0;
+};
+
+// appends blocks to a record file; safe to call from several threads
+class GameRecordWriter {
+public:
+    ~GameRecordWriter() { close(); }
+
+    // creates the file, or appends to an existing one for the same board
+    bool open(const std::string& path, const RecordBoard& b) {
+        close();
+        board = b;
+        file = fopen(path.c_str(), "ab+");
+        if(!file) return false;
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        unsigned char header[RECORD_HEADER_SIZE] = {};
+        if(size == 0) {
+            storeLE(header, RECORD_FILE_MAGIC, 4);
+            storeLE(header + 4, RECORD_VERSION, 2);
+            storeLE(header + 6, (uint32_t)b.width, 2);
+            storeLE(header + 8, (uint32_t)b.height, 2);
+            storeLE(header + 10, (uint32_t)b.k, 2);
+            header[12] = (unsigned char)b.bitsPerMove();
+            fwrite(header, 1, sizeof(header), file);
+            fflush(file);
+            return true;
+        }
+        fseek(file, 0, SEEK_SET);
+        bool ok = fread(header, 1, sizeof(header), file) == sizeof(header) &&
+                  loadLE(header, 4) == RECORD_FILE_MAGIC && loadLE(header + 4, 2) == RECORD_VERSION &&
+                  (int)loadLE(header + 6, 2) == b.width && (int)loadLE(header + 8, 2) == b.height &&
+                  (int)loadLE(header + 10, 2) == b.k;
+        if(!ok) {
+            fprintf(stderr, "%s is not a record file for %dx%d k=%d\n", path.c_str(), b.width, b.height, b.k);
+            close();
+            return false;
+        }
+        // cut off a block left incomplete by a crash, or new blocks would
+        // end up behind it where the reader never looks
+        long end = (long)RECORD_HEADER_SIZE;
+        unsigned char block[RECORD_BLOCK_HEADER_SIZE];
+        while(fseek(file, end, SEEK_SET) == 0 && fread(block, 1, sizeof(block), file) == sizeof(block) &&
+              loadLE(block, 4) == RECORD_BLOCK_MAGIC) {
+            long next = end + (long)RECORD_BLOCK_HEADER_SIZE + (long)loadLE(block + 8, 4);
+            if(next > size) break;
+            end = next;
+        }
+        if(end < size && ftruncate(fileno(file), end) != 0) {
+            perror(path.c_str());
+            close();
+            return false;
+        }
+        fseek(file, 0, SEEK_END);
+        return true;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+    const RecordBoard& recordBoard() const { return board; }
+
+    // write the block out (if it has games) and clear it
+    bool append(GameRecordBlock& block) {
+        if(!file || block.empty()) { block.clear(); return file != nullptr; }
+        unsigned char header[RECORD_BLOCK_HEADER_SIZE];
+        storeLE(header, RECORD_BLOCK_MAGIC, 4);
+        storeLE(header + 4, block.games(), 4);
+        storeLE(header + 8, (uint32_t)block.bytes(), 4);
+        storeLE(header + 12, recordChecksum(block.bytesPtr(), block.bytes()), 4);
+        std::lock_guard<std::mutex> lock(mutex);
+        bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+                  fwrite(block.bytesPtr(), 1, block.bytes(), file) == block.bytes() &&
+                  fflush(file) == 0;
+        block.clear();
+        return ok;
+    }
+
+    void close() {
+        if(file) fclose(file);
+        file = nullptr;
+    }
+
+private:
+    FILE* file = nullptr;
+    RecordBoard board;
+    std::mutex mutex;
+};
+
+// one game inside the mapping
+struct GameView {
+    const unsigned char* moveData = nullptr;
+    int moveCount = 0;
+    int result = 0; // 0 unfinished, 1 X, -1 O, 2 draw
+    int bits = 4;
+
+    int move(int i) const {
+        if(bits == 4) return (moveData[i >> 1] >> ((i & 1) * 4)) & 0xF;
+        if(bits == 8) return moveData[i];
+        return moveData[2 * i] | moveData[2 * i + 1] << 8;
+    }
+};
+
+struct RecordBlockInfo {
+    size_t offset;   // of the data, in the file
+    uint32_t games;
+    uint32_t bytes;
+    uint32_t checksum;
+};
+
+class GameRecordReader {
+public:
+    ~GameRecordReader() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) { perror(path.c_str()); return false; }
+        struct stat st;
+        if(fstat(fd, &st) < 0 || (size_t)st.st_size < RECORD_HEADER_SIZE) {
+            fprintf(stderr, "%s: not a record file\n", path.c_str());
+            ::close(fd);
+            return false;
+        }
+        size = (size_t)st.st_size;
+        void* m = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if(m == MAP_FAILED) { perror("mmap"); size = 0; return false; }
+        base = (const unsigned char*)m;
+        madvise(m, size, MADV_SEQUENTIAL);
+
+        if(loadLE(base, 4) != RECORD_FILE_MAGIC || loadLE(base + 4, 2) != RECORD_VERSION) {
+            fprintf(stderr, "%s: not a record file (or a newer version)\n", path.c_str());
+            close();
+            return false;
+        }
+        board.width = (int)loadLE(base + 6, 2);
+        board.height = (int)loadLE(base + 8, 2);
+        board.k = (int)loadLE(base + 10, 2);
+        bits = base[12];
+        if(!board.valid() || bits != board.bitsPerMove()) {
+            fprintf(stderr, "%s: bad board %dx%d k=%d, %d bits per move\n", path.c_str(), board.width, board.height, board.k, bits);
+            close();
+            return false;
+        }
+
+        // block index from the headers alone
+        size_t at = RECORD_HEADER_SIZE;
+        totalGames = 0;
+        while(at + RECORD_BLOCK_HEADER_SIZE <= size) {
+            const unsigned char* h = base + at;
+            RecordBlockInfo b{at + RECORD_BLOCK_HEADER_SIZE, loadLE(h + 4, 4), loadLE(h + 8, 4), loadLE(h + 12, 4)};
+            if(loadLE(h, 4) != RECORD_BLOCK_MAGIC || b.offset + b.bytes > size) break;
+            blockList.push_back(b);
+            totalGames += b.games;
+            at = b.offset + b.bytes;
+        }
+        truncatedBytes = size - at;
+        return true;
+    }
+
+    void close() {
+        if(base) munmap((void*)base, size);
+        base = nullptr;
+        size = 0;
+        blockList.clear();
+    }
+
+    const RecordBoard& recordBoard() const { return board; }
+    uint64_t games() const { return totalGames; }
+    const std::vector<RecordBlockInfo>& blocks() const { return blockList; }
+    size_t fileBytes() const { return size; }
+    size_t ignoredBytes() const { return truncatedBytes; } // incomplete last block
+
+    bool verify(const RecordBlockInfo& b) const {
+        return recordChecksum(base + b.offset, b.bytes) == b.checksum;
+    }
+
+    // f(const GameView&) for every game of the block, in order
+    template <typename F>
+    void forEachGame(const RecordBlockInfo& b, F&& f) const {
+        const unsigned char* p = base + b.offset;
+        const unsigned char* end = p + b.bytes;
+        GameView g;
+        g.bits = bits;
+        for(uint32_t i=0;i<b.games && p < end;i++){
+            g.result = codeToResult(p[0] & 3);
+            g.moveCount = p[0] >> 2;
+            p++;
+            if(g.moveCount == 63) {
+                if(end - p < 2) break; // corrupt block
+                g.moveCount = (int)loadLE(p, 2);
+                p += 2;
+            }
+            g.moveData = p;
+            p += ((size_t)g.moveCount * bits + 7) / 8;
+            if(p > end) break; // corrupt block
+            f(g);
+        }
+    }
+
+    template <typename F>
+    void forEachGame(F&& f) const {
+        for(const RecordBlockInfo& b : blockList) forEachGame(b, f);
+    }
+
+    // game number n (0-based); walks the block index, then the block. Fails
+    // if the block does not match its checksum.
+    bool game(uint64_t n, GameView& out) const {
+        for(const RecordBlockInfo& b : blockList) {
+            if(n >= b.games) { n -= b.games; continue; }
+            if(!verify(b)) return false;
+            bool found = false;
+            uint64_t i = 0;
+            forEachGame(b, [&](const GameView& g) { if(i++ == n) { out = g; found = true; } });
+            return found;
+        }
+        return false;
+    }
+
+private:
+    const unsigned char* base = nullptr;
+    size_t size = 0;
+    size_t truncatedBytes = 0;
+    RecordBoard board;
+    int bits = 4;
+    std::vector<RecordBlockInfo> blockList;
+    uint64_t totalGames = 0;
+};
@@ -0,0 +1,435 @@
+// game_server.cpp
+// Multiplayer Three-in-a-Row server: many independent matches over TCP.
+//
+// One thread runs an epoll loop over non-blocking sockets and speaks the
+// fixed-size binary protocol in match_protocol.h. Every match is a 24-byte
+// slot (the moves so far at 4 bits each, bitboard GameState, the two
+// players' sockets) in one flat table, keyed by an id that carries the slot
+// index and a generation count, so a stale id from a finished match is
+// rejected instead of hitting whatever match reuses the slot. Replies are
+// queued per connection and written once per loop iteration, so a burst of
+// moves costs one send() per socket.
+// --record appends every finished match to a record file (game_record.h),
+// one block at a time: when it is full, when the server is idle and at exit.
+//
+// Linux only (epoll). Try it with loadgen, e.g.
+//   ./game_server --port 7777 &
+//   ./loadgen --port 7777 --pairs 16 --matches 128
+//
+// Usage: game_server [--host ADDR] [--port P] [--stats SECONDS] [--record FILE]
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "game_record.h"
+#include "game_state.h"
+#include "match_protocol.h"
+
+volatile sig_atomic_t stopRequested = 0;
+
+void onSignal(int) { stopRequested = 1; }
+
+// match ids: low 20 bits slot, high 12 bits generation of that slot. Freed
+// slots are reused oldest first, so an id only comes back after its slot has
+// been reused 4096 times, not after 256 quick matches on one hot slot.
+const uint32_t SLOT_BITS = 20;
+const uint32_t SLOT_MASK = (1u << SLOT_BITS) - 1;
+const uint32_t GENERATION_MASK = (1u << (32 - SLOT_BITS)) - 1;
+const uint32_t NO_MATCH = SLOT_MASK; // slot index never handed out: the table is full
+
+struct Match {
+    uint64_t moves = 0;           // cell of move i in bits 4i..4i+3
+    GameState state;
+    int32_t player[2] = {-1, -1}; // sockets of X and O, -1 if none
+    uint16_t generation = 0;      // low 12 bits used
+    bool live = false;
+};
+static_assert(sizeof(Match) == 24, "a match slot is 24 bytes");
+
+struct Connection {
+    int fd = -1;
+    std::vector<unsigned char> in;   // partial frame left from the last read
+    std::vector<unsigned char> out;  // queued replies
+    size_t outPos = 0;               // bytes of `out` already sent
+    bool queued = false;             // in the flush list
+    bool waitingWritable = false;    // registered for EPOLLOUT
+    std::vector<uint32_t> matches;   // ids this socket plays in (may be stale)
+    size_t compactAt = 64;
+};
+
+struct ServerStats {
+    uint64_t connections = 0, matchesCreated = 0, matchesFinished = 0, moves = 0, errors = 0;
+};
+
+class GameServer {
+public:
+    bool listenOn(const std::string& host, int port) {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if(listenFd < 0) { perror("socket"); return false; }
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        if(inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+            fprintf(stderr, "bad address %s\n", host.c_str());
+            return false;
+        }
+        if(bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind"); return false; }
+        if(listen(listenFd, SOMAXCONN) < 0) { perror("listen"); return false; }
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if(epollFd < 0) { perror("epoll_create1"); return false; }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = listenFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+        return true;
+    }
+
+    void run(double statsInterval) {
+        const int MAX_EVENTS = 256;
+        epoll_event events[MAX_EVENTS];
+        auto lastStats = std::chrono::steady_clock::now();
+        ServerStats shown;
+        while(!stopRequested) {
+            int n = epoll_wait(epollFd, events, MAX_EVENTS, 500);
+            if(n < 0 && errno != EINTR) { perror("epoll_wait"); break; }
+            if(n == 0) flushRecord(); // idle: don't sit on finished games
+            for(int i=0;i<n;i++){
+                int fd = events[i].data.fd;
+                if(fd == listenFd) { acceptAll(); continue; }
+                if(events[i].events & (EPOLLHUP | EPOLLERR)) { closeConnection(fd); continue; }
+                if(events[i].events & EPOLLIN) readFrom(fd);
+                if((events[i].events & EPOLLOUT) && connection(fd)) flush(*connection(fd));
+            }
+            flushAll();
+
+            auto now = std::chrono::steady_clock::now();
+            double since = std::chrono::duration<double>(now - lastStats).count();
+            if(statsInterval > 0.0 && since >= statsInterval && stats.moves != shown.moves) {
+                printf("%zu connections, %zu live matches, %.0f matches/s, %.0f moves/s\n",
+                       openConnections, liveMatches,
+                       (stats.matchesFinished - shown.matchesFinished) / since, (stats.moves - shown.moves) / since);
+                fflush(stdout);
+                shown = stats;
+                lastStats = now;
+            }
+        }
+    }
+
+    void shutdown() {
+        for(auto& c : connections) if(c) close(c->fd);
+        connections.clear();
+        if(epollFd >= 0) close(epollFd);
+        if(listenFd >= 0) close(listenFd);
+    }
+
+    const ServerStats& totals() const { return stats; }
+
+    bool record(const std::string& path) { return recordFile.open(path, RecordBoard()); }
+    void flushRecord() { recordFile.append(recordBlock); }
+
+private:
+    int listenFd = -1, epollFd = -1;
+    std::vector<std::unique_ptr<Connection>> connections; // by fd
+    std::vector<int> flushList;
+    std::vector<Match> matches;
+    std::deque<uint32_t> freeSlots; // oldest first
+    size_t openConnections = 0, liveMatches = 0;
+    ServerStats stats;
+    GameRecordWriter recordFile;
+    GameRecordBlock recordBlock;
+
+    Connection* connection(int fd) {
+        return fd >= 0 && fd < (int)connections.size() ? connections[fd].get() : nullptr;
+    }
+
+    void acceptAll() {
+        for(;;){
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if(fd < 0) {
+                if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) perror("accept4");
+                return;
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            if(fd >= (int)connections.size()) connections.resize(fd + 1);
+            connections[fd].reset(new Connection());
+            connections[fd]->fd = fd;
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+            openConnections++;
+            stats.connections++;
+        }
+    }
+
+    void closeConnection(int fd) {
+        Connection* c = connection(fd);
+        if(!c) return;
+        // the opponents of every match still running get told
+        for(uint32_t id : c->matches) {
+            Match* m = find(id);
+            if(!m) continue;
+            int side = m->player[0] == fd ? 0 : m->player[1] == fd ? 1 : -1;
+            if(side < 0) continue;
+            int other = m->player[1 - side];
+            if(other >= 0) send(other, {MSG_OPPONENT_LEFT, 0, 0, id});
+            release(id);
+        }
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        connections[fd].reset();
+        openConnections--;
+    }
+
+    void readFrom(int fd) {
+        unsigned char buf[65536];
+        for(;;){
+            Connection* c = connection(fd);
+            if(!c) return;
+            ssize_t got = recv(fd, buf, sizeof(buf), 0);
+            if(got == 0) { closeConnection(fd); return; }
+            if(got < 0) {
+                if(errno == EINTR) continue;
+                if(errno != EAGAIN && errno != EWOULDBLOCK) closeConnection(fd);
+                return;
+            }
+            // whole frames straight from the read buffer, the rest is kept
+            const unsigned char* p = buf;
+            size_t left = (size_t)got;
+            if(!c->in.empty()) {
+                size_t need = MSG_SIZE - c->in.size();
+                size_t take = left < need ? left : need;
+                c->in.insert(c->in.end(), p, p + take);
+                p += take;
+                left -= take;
+                if(c->in.size() < (size_t)MSG_SIZE) continue;
+                Msg m = decodeMsg(c->in.data());
+                c->in.clear();
+                handle(fd, m);
+            }
+            for(;left >= (size_t)MSG_SIZE;p+=MSG_SIZE,left-=MSG_SIZE){
+                handle(fd, decodeMsg(p));
+                if(!connection(fd)) return;
+            }
+            c = connection(fd);
+            if(c) c->in.assign(p, p + left);
+            if((size_t)got < sizeof(buf)) return;
+        }
+    }
+
+    Match* find(uint32_t id) {
+        uint32_t slot = id & SLOT_MASK;
+        if(slot >= matches.size()) return nullptr;
+        Match& m = matches[slot];
+        if(!m.live || m.generation != id >> SLOT_BITS) return nullptr;
+        return &m;
+    }
+
+    // NO_MATCH once every slot is taken
+    uint32_t allocate() {
+        uint32_t slot;
+        if(!freeSlots.empty()) { slot = freeSlots.front(); freeSlots.pop_front(); }
+        else if(matches.size() < NO_MATCH) { slot = (uint32_t)matches.size(); matches.emplace_back(); }
+        else return NO_MATCH;
+        Match& m = matches[slot];
+        m.state.reset();
+        m.player[0] = m.player[1] = -1;
+        m.moves = 0;
+        m.live = true;
+        liveMatches++;
+        return slot | (uint32_t)m.generation << SLOT_BITS;
+    }
+
+    void release(uint32_t id) {
+        Match& m = matches[id & SLOT_MASK];
+        m.live = false;
+        m.generation = (m.generation + 1) & GENERATION_MASK;
+        freeSlots.push_back(id & SLOT_MASK);
+        liveMatches--;
+    }
+
+    // remember a match on the socket's list, dropping finished ones now and then
+    void track(Connection& c, uint32_t id) {
+        c.matches.push_back(id);
+        if(c.matches.size() < c.compactAt) return;
+        size_t keep = 0;
+        for(uint32_t m : c.matches) if(find(m)) c.matches[keep++] = m;
+        c.matches.resize(keep);
+        c.compactAt = keep * 2 > 64 ? keep * 2 : 64;
+    }
+
+    void fail(int fd, uint32_t match, MsgError e) {
+        stats.errors++;
+        send(fd, {MSG_ERROR, e, 0, match});
+    }
+
+    void handle(int fd, const Msg& m) {
+        Connection& c = *connection(fd);
+        switch(m.type) {
+        case MSG_CREATE: {
+            uint32_t id = allocate();
+            if(id == NO_MATCH) { fail(fd, 0, ERR_MATCH_FULL); break; }
+            find(id)->player[0] = fd;
+            track(c, id);
+            stats.matchesCreated++;
+            send(fd, {MSG_CREATED, 1, 0, id});
+            break;
+        }
+        case MSG_JOIN: {
+            Match* match = find(m.match);
+            if(!match) { fail(fd, m.match, ERR_NO_MATCH); break; }
+            if(match->player[1] >= 0) { fail(fd, m.match, ERR_MATCH_FULL); break; }
+            match->player[1] = fd;
+            track(c, m.match);
+            send(fd, {MSG_JOINED, -1, 0, m.match});
+            send(match->player[0], {MSG_OPPONENT_JOINED, -1, 0, m.match});
+            break;
+        }
+        case MSG_MOVE: {
+            Match* match = find(m.match);
+            if(!match) { fail(fd, m.match, ERR_NO_MATCH); break; }
+            if(match->player[1] < 0) { fail(fd, m.match, ERR_NOT_STARTED); break; }
+            int side = match->state.sideToMove();
+            if(match->player[side == 1 ? 0 : 1] != fd) { fail(fd, m.match, ERR_NOT_YOUR_TURN); break; }
+            if(m.cell >= 9 || !match->state.isEmpty(m.cell)) { fail(fd, m.match, ERR_ILLEGAL_MOVE); break; }
+            match->moves |= (uint64_t)m.cell << (4 * match->state.moveCount());
+            match->state.play(m.cell, side);
+            stats.moves++;
+            int8_t result = (int8_t)match->state.result();
+            int other = match->player[side == 1 ? 1 : 0];
+            send(fd, {MSG_MOVED, result, m.cell, m.match});
+            send(other, {MSG_OPPONENT_MOVED, result, m.cell, m.match});
+            if(result != 0) {
+                if(recordFile.isOpen()) recordMatch(*match, result);
+                release(m.match);
+                stats.matchesFinished++;
+            }
+            break;
+        }
+        default:
+            fail(fd, m.match, ERR_BAD_MESSAGE);
+        }
+    }
+
+    void recordMatch(const Match& m, int result) {
+        int moves[9];
+        int n = m.state.moveCount();
+        for(int i=0;i<n;i++) moves[i] = (int)(m.moves >> (4 * i) & 0xF);
+        recordBlock.add(moves, n, result);
+        if(recordBlock.full()) flushRecord();
+    }
+
+    void send(int fd, const Msg& m) {
+        Connection* c = connection(fd);
+        if(!c) return;
+        size_t at = c->out.size();
+        c->out.resize(at + MSG_SIZE);
+        encodeMsg(m, &c->out[at]);
+        if(!c->queued) {
+            c->queued = true;
+            flushList.push_back(fd);
+        }
+    }
+
+    void flushAll() {
+        // by index: a failed send closes a socket, which may queue more
+        for(size_t i=0;i<flushList.size();i++){
+            int fd = flushList[i];
+            Connection* c = connection(fd);
+            if(!c) continue;
+            c->queued = false;
+            if(!c->waitingWritable) flush(*c);
+        }
+        flushList.clear();
+    }
+
+    // send what the socket takes; wait for EPOLLOUT if it is full
+    void flush(Connection& c) {
+        while(c.outPos < c.out.size()) {
+            ssize_t sent = ::send(c.fd, c.out.data() + c.outPos, c.out.size() - c.outPos, MSG_NOSIGNAL);
+            if(sent < 0) {
+                if(errno == EINTR) continue;
+                if(errno == EAGAIN || errno == EWOULDBLOCK) break;
+                closeConnection(c.fd);
+                return;
+            }
+            c.outPos += (size_t)sent;
+        }
+        bool pending = c.outPos < c.out.size();
+        if(!pending) {
+            c.out.clear();
+            c.outPos = 0;
+        }
+        if(pending != c.waitingWritable) {
+            c.waitingWritable = pending;
+            epoll_event ev{};
+            ev.events = pending ? EPOLLIN | EPOLLOUT : EPOLLIN;
+            ev.data.fd = c.fd;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, c.fd, &ev);
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    std::string host = "127.0.0.1";
+    int port = 7777;
+    double statsInterval = 5.0;
+    std::string recordPath;
+
+    for(int i=1;i<argc;i++){
+        std::string arg = argv[i];
+        bool hasValue = i+1 < argc;
+        if(arg == "--host" && hasValue) host = argv[++i];
+        else if(arg == "--port" && hasValue) port = atoi(argv[++i]);
+        else if(arg == "--stats" && hasValue) statsInterval = atof(argv[++i]);
+        else if(arg == "--record" && hasValue) recordPath = argv[++i];
+        else {
+            fprintf(stderr, "Usage: %s [--host ADDR] [--port P] [--stats SECONDS] [--record FILE]\n"
+                            "  --stats  seconds between throughput lines, 0 for none (default 5)\n", argv[0]);
+            return 1;
+        }
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    GameServer server;
+    if(!server.listenOn(host, port)) return 1;
+    if(!recordPath.empty() && !server.record(recordPath)) {
+        fprintf(stderr, "cannot open %s\n", recordPath.c_str());
+        return 1;
+    }
+    printf("listening on %s:%d\n", host.c_str(), port);
+    fflush(stdout);
+    server.run(statsInterval);
+
+    const ServerStats& s = server.totals();
+    printf("%llu connections, %llu matches created, %llu finished, %llu moves, %llu errors\n",
+           (unsigned long long)s.connections, (unsigned long long)s.matchesCreated,
+           (unsigned long long)s.matchesFinished, (unsigned long long)s.moves, (unsigned long long)s.errors);
+    server.flushRecord();
+    server.shutdown();
+    return 0;
+}
@@ -0,0 +1,126 @@
+// game_state.h
+// Bitboard game state for Three-in-a-Row (Tic-Tac-Toe).
+//
+// X and O are kept as two 9-bit masks (bit i = cell i, row-major from the
+// top-left corner, same numbering as the board in main.cpp). Win, draw and
+// the winning line are resolved with a single lookup into a table generated
+// at compile time, so the rules can be evaluated without any loops.
+//
+// No GLFW / OpenGL dependency: this header is shared with headless tools.
+
+#pragma once
+
+#include <cstdint>
+
+const uint16_t FULL_BOARD = 0x1FF; // all 9 cells
+
+// rows, cols, diagonals (cell indices)
+constexpr int WIN_LINES[8][3] = {
+    {0,1,2},{3,4,5},{6,7,8},
+    {0,3,6},{1,4,7},{2,5,8},
+    {0,4,8},{2,4,6}
+};
+
+// center, corners, edges: the order searches try moves in
+constexpr int MOVE_ORDER[9] = {4,0,2,6,8,1,3,5,7};
+
+// the same lines as 9-bit masks
+constexpr uint16_t WIN_MASKS[8] = {
+    0x007, 0x038, 0x1C0,
+    0x049, 0x092, 0x124,
+    0x111, 0x054
+};
+
+// For every 9-bit mask: index of the first winning line it contains, or -1.
+struct WinLineTable {
+    int8_t line[512];
+};
+
+constexpr WinLineTable makeWinLineTable() {
+    WinLineTable t{};
+    for(int m=0;m<512;m++){
+        t.line[m] = -1;
+        for(int i=0;i<8;i++){
+            if((m & WIN_MASKS[i]) == WIN_MASKS[i]) { t.line[m] = (int8_t)i; break; }
+        }
+    }
+    return t;
+}
+
+inline constexpr WinLineTable WIN_LINE_TABLE = makeWinLineTable();
+
+const int NUM_POSITIONS = 19683; // 3^9 base-3 encodings
+
+// For every 9-bit mask: sum of 3^i over its set bits.
+struct TernaryTable {
+    uint16_t value[512];
+};
+
+constexpr TernaryTable makeTernaryTable() {
+    TernaryTable t{};
+    for(int m=0;m<512;m++){
+        int pow3 = 1;
+        for(int i=0;i<9;i++){
+            if(m >> i & 1) t.value[m] += (uint16_t)pow3;
+            pow3 *= 3;
+        }
+    }
+    return t;
+}
+
+inline constexpr TernaryTable TERNARY_TABLE = makeTernaryTable();
+
+// base-3 encoding of a position: digit i is 0 empty, 1 X, 2 O
+constexpr int ternaryIndex(uint16_t x, uint16_t o) {
+    return TERNARY_TABLE.value[x] + 2 * TERNARY_TABLE.value[o];
+}
+
+struct GameState {
+    uint16_t x = 0; // cells occupied by X
+    uint16_t o = 0; // cells occupied by O
+
+    void reset() { x = 0; o = 0; }
+
+    // base-3 encoding, 0..NUM_POSITIONS-1
+    int index() const { return ternaryIndex(x, o); }
+
+    uint16_t occupied() const { return x | o; }
+    uint16_t emptyCells() const { return (uint16_t)(~(x | o) & FULL_BOARD); }
+    bool isEmpty(int i) const { return !((x | o) >> i & 1); }
+    int moveCount() const { return __builtin_popcount(x | o); }
+
+    // 1 => X, -1 => O (X always moves first)
+    int sideToMove() const { return (moveCount() & 1) ? -1 : 1; }
+
+    // 0 empty, 1 = X, -1 = O
+    int cell(int i) const {
+        if(x >> i & 1) return 1;
+        if(o >> i & 1) return -1;
+        return 0;
+    }
+
+    void play(int i, int player) {
+        if(player == 1) x |= (uint16_t)(1u << i);
+        else            o |= (uint16_t)(1u << i);
+    }
+
+    // 0 none, 1 X, -1 O
+    int winner() const {
+        if(WIN_LINE_TABLE.line[x] >= 0) return 1;
+        if(WIN_LINE_TABLE.line[o] >= 0) return -1;
+        return 0;
+    }
+
+    // index into WIN_LINES of the completed line, or -1
+    int winningLine() const {
+        int l = WIN_LINE_TABLE.line[x];
+        return l >= 0 ? l : WIN_LINE_TABLE.line[o];
+    }
+
+    // 0 still playing, 1 X wins, -1 O wins, 2 draw
+    int result() const {
+        int w = winner();
+        if(w != 0) return w;
+        return occupied() == FULL_BOARD ? 2 : 0;
+    }
+};
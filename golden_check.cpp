@@ -0,0 +1,243 @@
+// golden_check.cpp
+// Golden-image pixel check for the renderers (no window needed).
+//
+// Renders the board in every state of board_scenes.h with
+// drawBoardFrame() (board_renderer.h), the frame main.cpp's renderBoard()
+// draws, and the modern_gl_a1 picture with drawShapeFrame()
+// (shape_scene.h), the frame its display() draws, into an offscreen
+// framebuffer at fixed resolutions, and compares every image with a
+// reference PNG in golden/:
+//
+//   golden_check --update   render and (re)write the references
+//   golden_check            compare; exit code 1 if any image differs
+//
+// Frames are read back asynchronously through a ring of pixel buffer
+// objects (offscreen.h: AsyncReadback), so the GPU keeps drawing the next
+// cases while the previous ones are compared. A pixel counts as different
+// if any color channel differs by more than --tolerance (alpha is ignored,
+// it never reaches the window); an image fails if more than --max-bad of
+// its pixels differ. For a failed image the actual render and a diff mask
+// are written next to the reference (*.actual.png, *.diff.png). Run it from
+// this folder so the shaders/ paths resolve. The committed references were
+// rendered by Mesa llvmpipe.
+//
+// Usage: golden_check [--update] [--dir DIR] [--tolerance T] [--max-bad FRACTION] [--scene TEXT]
+
+#include <GLAD/glad.h>
+
+#include <png.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "offscreen.h"
+#include "board.h"
+#include "board_renderer.h"
+#include "board_scenes.h"
+#include "shape_renderer.h"
+#include "shape_scene.h"
+
+struct GoldenCase {
+    std::string name; // file name without .png
+    int width, height;
+    std::function<void()> draw;
+};
+
+// "board 3x3 X wins" at 300x300 -> "board_3x3_x_wins_300x300"
+std::string fileStem(const std::string& name, int w, int h) {
+    std::string s;
+    for(char c : name) s += isalnum((unsigned char)c) ? (char)tolower((unsigned char)c) : '_';
+    return s + "_" + std::to_string(w) + "x" + std::to_string(h);
+}
+
+// RGBA8, rows bottom first like glReadPixels
+bool savePng(const std::string& path, int w, int h, const std::vector<unsigned char>& rgba) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if(!f) return false;
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png_create_info_struct(png);
+    if(setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        fclose(f);
+        return false;
+    }
+    png_init_io(png, f);
+    png_set_IHDR(png, info, w, h, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png, info);
+    for(int y=h-1;y>=0;y--) png_write_row(png, (png_bytep)&rgba[(size_t)y * w * 4]);
+    png_write_end(png, nullptr);
+    png_destroy_write_struct(&png, &info);
+    fclose(f);
+    return true;
+}
+
+// any PNG, converted to RGBA8 with rows bottom first
+bool loadPng(const std::string& path, int& w, int& h, std::vector<unsigned char>& rgba) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if(!f) return false;
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png_create_info_struct(png);
+    if(setjmp(png_jmpbuf(png))) {
+        png_destroy_read_struct(&png, &info, nullptr);
+        fclose(f);
+        return false;
+    }
+    png_init_io(png, f);
+    png_read_info(png, info);
+    w = (int)png_get_image_width(png, info);
+    h = (int)png_get_image_height(png, info);
+    png_set_expand(png);
+    png_set_strip_16(png);
+    png_set_gray_to_rgb(png);
+    png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+    png_read_update_info(png, info);
+    rgba.resize((size_t)w * h * 4);
+    for(int y=h-1;y>=0;y--) png_read_row(png, &rgba[(size_t)y * w * 4], nullptr);
+    png_destroy_read_struct(&png, &info, nullptr);
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool update = false;
+    std::string dir = "golden";
+    int tolerance = 2;
+    double maxBad = 0.001;
+    std::string filter;
+
+    for(int i=1;i<argc;i++){
+        std::string arg = argv[i];
+        bool hasValue = i+1 < argc;
+        if(arg == "--update") update = true;
+        else if(arg == "--dir" && hasValue) dir = argv[++i];
+        else if(arg == "--tolerance" && hasValue) tolerance = atoi(argv[++i]);
+        else if(arg == "--max-bad" && hasValue) maxBad = atof(argv[++i]);
+        else if(arg == "--scene" && hasValue) filter = argv[++i];
+        else {
+            fprintf(stderr, "Usage: %s [--update] [--dir DIR] [--tolerance T] [--max-bad FRACTION] [--scene TEXT]\n"
+                            "  --tolerance  per channel difference still counted as equal (default 2)\n"
+                            "  --max-bad    fraction of differing pixels allowed per image (default 0.001)\n", argv[0]);
+            return 1;
+        }
+    }
+    if(update) mkdir(dir.c_str(), 0755);
+
+    OffscreenContext offscreen;
+    if(!offscreen.init(300, 300)) return 1;
+
+    BoardRenderer boardRenderer;
+    ShapeRenderer shapes;
+    if(!boardRenderer.init() || !shapes.init(360)) {
+        offscreen.destroy();
+        return 1;
+    }
+
+    // --- cases: every board state at two sizes, then the shape scenes ---
+    Board board;
+    BoardScene boardScene;
+    std::vector<GoldenCase> cases;
+    const int boardSizes[2][2] = {{300, 300}, {640, 480}};
+    for(const BoardSceneCase& c : boardSceneCases()) {
+        for(const auto& size : boardSizes) {
+            int w = size[0], h = size[1];
+            cases.push_back({fileStem(c.name, w, h), w, h, [&, w, h]() {
+                loadBoardSceneCase(c, board, boardScene);
+                drawBoardFrame(boardRenderer, boardScene, w, h);
+            }});
+        }
+    }
+    const GLfloat identity[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
+    const int shapeSizes[2][2] = {{500, 500}, {800, 600}};
+    for(const auto& size : shapeSizes) {
+        cases.push_back({fileStem("shapes default", size[0], size[1]), size[0], size[1], [&]() {
+            shapes.clear();
+            addDefaultShapes(shapes);
+            drawShapeFrame(shapes, identity);
+        }});
+    }
+    cases.push_back({fileStem("stress 2000", 500, 500), 500, 500, [&]() {
+        shapes.clear();
+        addStressShapes(shapes, 2000);
+        drawShapeFrame(shapes, identity);
+    }});
+
+    // --- render, reading back a few cases behind ---
+    int checked = 0, failed = 0;
+    std::vector<unsigned char> actual, expected;
+    auto finish = [&](int caseIndex, int w, int h) {
+        const GoldenCase& c = cases[caseIndex];
+        std::string path = dir + "/" + c.name + ".png";
+        checked++;
+        if(update) {
+            if(!savePng(path, w, h, actual)) { fprintf(stderr, "cannot write %s\n", path.c_str()); failed++; }
+            else printf("wrote  %s\n", path.c_str());
+            return;
+        }
+        int ew, eh;
+        if(!loadPng(path, ew, eh, expected)) {
+            printf("MISSING %s (run with --update)\n", path.c_str());
+            failed++;
+            return;
+        }
+        if(ew != w || eh != h) {
+            printf("FAIL   %s: size %dx%d, reference %dx%d\n", c.name.c_str(), w, h, ew, eh);
+            failed++;
+            return;
+        }
+        size_t bad = 0;
+        int maxDiff = 0;
+        std::vector<unsigned char> diff(actual.size(), 0);
+        for(size_t p=0;p<actual.size();p+=4){
+            int d = 0;
+            for(int ch=0;ch<3;ch++) d = std::max(d, abs((int)actual[p+ch] - (int)expected[p+ch]));
+            maxDiff = std::max(maxDiff, d);
+            diff[p+3] = 255;
+            if(d > tolerance) { bad++; diff[p] = 255; }
+            else diff[p+1] = diff[p+2] = (unsigned char)(actual[p+1] / 4); // faint copy for orientation
+        }
+        double fraction = (double)bad / ((size_t)w * h);
+        if(fraction > maxBad) {
+            printf("FAIL   %s: %zu pixels differ (%.3f%%), max channel diff %d\n",
+                   c.name.c_str(), bad, 100.0 * fraction, maxDiff);
+            savePng(dir + "/" + c.name + ".actual.png", w, h, actual);
+            savePng(dir + "/" + c.name + ".diff.png", w, h, diff);
+            failed++;
+        } else {
+            printf("ok     %s (%zu pixels differ, max channel diff %d)\n", c.name.c_str(), bad, maxDiff);
+        }
+    };
+
+    AsyncReadback readback(3);
+    auto collectOne = [&]() {
+        int w = 0, h = 0, tag = 0;
+        if(readback.collect(actual, w, h, tag)) finish(tag, w, h);
+        else { printf("FAIL   %s: readback failed\n", cases[tag].name.c_str()); failed++; }
+    };
+    for(int i=0;i<(int)cases.size();i++){
+        const GoldenCase& c = cases[i];
+        if(!filter.empty() && c.name.find(filter) == std::string::npos) continue;
+        if(readback.full()) collectOne();
+        offscreen.resize(c.width, c.height);
+        c.draw();
+        readback.read(c.width, c.height, i);
+    }
+    while(readback.pending() > 0) collectOne();
+
+    GLenum err = glGetError();
+    if(err != GL_NO_ERROR) { fprintf(stderr, "OpenGL error 0x%x\n", err); failed++; }
+    printf("%d images %s, %d failed\n", checked, update ? "written" : "checked", failed);
+
+    readback.destroy();
+    shapes.destroy();
+    boardRenderer.destroy();
+    shaderCache().clear();
+    offscreen.destroy();
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+// heatmap.h
+// Move-evaluation heatmap for main.cpp: the value of playing each empty
+// cell for the side to move, computed on a worker thread.
+//
+// 3x3 boards read every move's exact result from the outcome table (win,
+// draw or loss), and so do positions a position table covers
+// (position_db.h, setDatabase()). Other boards run MCTS in rounds of
+// growing length (on one MctsSearcher, whose node pools every round
+// reuses) and publish the win rate per cell after every round, so a rough
+// map shows up after ~50 ms and sharpens until the time budget is spent.
+//
+// The caller (the render thread) never waits on an evaluation:
+//  - request() hands the worker a new board and raises the cancel flag
+//    that the search polls, so a search for an old position stops
+//    within a batch of playouts. The mutex only guards the hand-over of
+//    the pending board and the worker's sleep; it is never held while
+//    evaluating.
+//  - Results come back through a single-slot mailbox, an atomic pointer
+//    the worker exchanges a fresh Heatmap into and take() exchanges it
+//    out of. A result nobody picked up is overwritten by the next one. A
+//    second atomic slot hands the reader's old buffer back to the worker,
+//    so the steady state allocates nothing.
+// Results carry the generation of their request; the caller drops stale
+// ones (older than its last request()).
+//
+// No GLFW / OpenGL dependency.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "board.h"
+#include "mcts.h"
+#include "outcome_table.h"
+#include "position_db.h"
+#include "profiler.h"
+
+const float HEAT_NONE = -1.0f; // cell not evaluated (occupied, or MCTS never tried it)
+
+struct Heatmap {
+    uint64_t generation = 0;
+    std::vector<float> value; // per cell for the side to move: 1 win, 0.5 draw, 0 loss; HEAT_NONE
+    bool exact = false;       // from the outcome table, not sampled
+    bool final = false;       // no more rounds will follow for this generation
+    uint64_t playouts = 0;    // MCTS playouts so far
+    double seconds = 0.0;     // since the request
+};
+
+// exact values from the outcome table; cells must hold 9 entries
+inline void tableHeatmap(const GameState& s, float* cells) {
+    for(int i=0;i<9;i++){
+        cells[i] = HEAT_NONE;
+        if(!s.isEmpty(i) || s.result() != 0) continue;
+        GameState child = s;
+        child.play(i, s.sideToMove());
+        // child scores are for the opponent, who moves next
+        int score = child.result() != 0 ? (child.winner() != 0 ? 1 : 0) : -lookupOutcome(child).score;
+        cells[i] = score > 0 ? 1.0f : score < 0 ? 0.0f : 0.5f;
+    }
+}
+
+class HeatmapWorker {
+public:
+    HeatmapWorker() = default;
+    HeatmapWorker(const HeatmapWorker&) = delete;
+    HeatmapWorker& operator=(const HeatmapWorker&) = delete;
+    ~HeatmapWorker() { stop(); }
+
+    // budget: seconds of MCTS per position; threads: search threads (0 => half the hardware)
+    void start(double budgetSeconds, int searchThreads = 0) {
+        if(thread.joinable()) return;
+        budget = budgetSeconds;
+        threads = searchThreads > 0 ? searchThreads : std::max(1, (int)std::thread::hardware_concurrency() / 2);
+        quit = false;
+        thread = std::thread(&HeatmapWorker::run, this);
+    }
+
+    // exact values for the positions it covers; set before start()
+    void setDatabase(const PositionDb* table) { db = table; }
+
+    void stop() {
+        if(!thread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+            hasJob = false;
+            cancel.store(true);
+        }
+        wake.notify_one();
+        thread.join();
+        delete mailbox.exchange(nullptr);
+        delete spare.exchange(nullptr);
+    }
+
+    // evaluate `board` from now on, abandoning the previous position;
+    // returns the generation its results will carry
+    uint64_t request(const Board& board) {
+        uint64_t g;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            g = ++requested;
+            job = board;
+            jobGeneration = g;
+            hasJob = true;
+            cancel.store(true);
+        }
+        wake.notify_one();
+        return g;
+    }
+
+    // stop evaluating without starting anything new
+    void abandon() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++requested;
+            hasJob = false;
+            cancel.store(true);
+        }
+    }
+
+    // newest published result, if any arrived since the last call;
+    // `out`'s old buffer goes back to the worker for reuse
+    bool take(Heatmap& out) {
+        Heatmap* h = mailbox.exchange(nullptr, std::memory_order_acquire);
+        if(!h) return false;
+        std::swap(out, *h);
+        delete spare.exchange(h, std::memory_order_acq_rel);
+        return true;
+    }
+
+private:
+    std::thread thread;
+    std::mutex mutex;              // job, jobGeneration, hasJob, quit, writes of cancel
+    std::condition_variable wake;
+    Board job;
+    uint64_t jobGeneration = 0;
+    uint64_t requested = 0;
+    bool hasJob = false;
+    bool quit = false;
+
+    std::atomic<bool> cancel{false};
+    std::atomic<Heatmap*> mailbox{nullptr}; // worker -> reader
+    std::atomic<Heatmap*> spare{nullptr};   // reader -> worker
+
+    double budget = 2.0;
+    int threads = 1;
+    const PositionDb* db = nullptr;
+    MctsSearcher searcher; // worker thread only
+
+    static constexpr double FIRST_ROUND = 0.05; // seconds; rounds double up to MAX_ROUND
+    static constexpr double MAX_ROUND = 0.4;
+
+    void run() {
+        PROFILE_THREAD("heatmap");
+        Board board;
+        std::vector<double> wins;
+        std::vector<uint32_t> visits;
+        for(;;){
+            uint64_t generation;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return quit || hasJob; });
+                if(quit) return;
+                board = job;
+                generation = jobGeneration;
+                hasJob = false;
+                // set and cleared under the lock, so it always belongs to
+                // the job the worker holds
+                cancel.store(false);
+            }
+            evaluate(board, generation, wins, visits);
+        }
+    }
+
+    Heatmap* blank(uint64_t generation, int cells) {
+        Heatmap* h = spare.exchange(nullptr, std::memory_order_acquire);
+        if(!h) h = new Heatmap();
+        h->generation = generation;
+        h->value.assign(cells, HEAT_NONE);
+        h->exact = h->final = false;
+        h->playouts = 0;
+        h->seconds = 0.0;
+        return h;
+    }
+
+    void publish(Heatmap* h) {
+        delete mailbox.exchange(h, std::memory_order_acq_rel); // drop a result nobody took
+    }
+
+    void evaluate(const Board& board, uint64_t generation, std::vector<double>& wins, std::vector<uint32_t>& visits) {
+        PROFILE_ZONE("HeatmapWorker::evaluate");
+        using clock = std::chrono::steady_clock;
+        auto start = clock::now();
+        bool fromDb = db && db->covers(board);
+        if(board.result() != 0 || board.isClassic() || fromDb) {
+            Heatmap* h = blank(generation, board.size());
+            if(board.isClassic()) tableHeatmap(toGameState(board), h->value.data());
+            else if(fromDb) db->moveValues(board, h->value.data());
+            h->exact = h->final = true;
+            publish(h);
+            return;
+        }
+
+        // the root statistics of every round are summed, so later rounds
+        // refine the earlier ones instead of starting over
+        wins.assign(board.size(), 0.0);
+        visits.assign(board.size(), 0);
+        MctsConfig cfg;
+        cfg.threads = threads;
+        cfg.cancel = &cancel;
+        uint64_t playouts = 0;
+        double round = FIRST_ROUND;
+        for(int r=0;;r++){
+            double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+            cfg.timeBudget = std::min(round, budget - elapsed);
+            cfg.seed = generation * 1000003ull + r;
+            MctsResult res = searcher.search(board, cfg);
+            if(cancel.load(std::memory_order_relaxed)) return;
+            for(int i=0;i<board.size();i++){
+                if(res.visits[i] == 0) continue;
+                visits[i] += res.visits[i];
+                wins[i] += (double)res.winRate[i] * res.visits[i];
+            }
+            playouts += res.playouts;
+
+            Heatmap* h = blank(generation, board.size());
+            for(int i=0;i<board.size();i++) if(visits[i]) h->value[i] = (float)(wins[i] / visits[i]);
+            h->playouts = playouts;
+            h->seconds = std::chrono::duration<double>(clock::now() - start).count();
+            bool done = h->seconds >= budget;
+            h->final = done;
+            publish(h); // the reader owns h from here on
+            if(done) return;
+            round = std::min(round * 2.0, MAX_ROUND);
+        }
+    }
+};
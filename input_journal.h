@@ -0,0 +1,148 @@
+// input_journal.h
+// Input journal for main.cpp: every input event of a session, timestamped,
+// so the session can be played back exactly for profiling.
+//
+// Events are recorded after the window-specific part has been taken out:
+// a click is stored as the board cell it hit (-1 outside the board), not as
+// pixels, so it replays the same at any window size; key presses are GLFW
+// key codes; window and framebuffer sizes are stored as they change. The
+// computer's MCTS moves are journaled too (JOURNAL_COMPUTER): a search
+// stops on a time budget, so the move it finds is not reproducible, and
+// playback waits for its own search to finish and then plays the recorded
+// move instead, which keeps the game identical while still doing the
+// search's work. Table and --db moves are deterministic and not journaled.
+//
+// The file is text, one event per line after a header with the board,
+// easy to diff or edit by hand:
+//   ttt-input 1 <width> <height> <k>
+//   <seconds> click <cell>
+//   <seconds> key <glfw key>
+//   <seconds> window <width> <height>
+//   <seconds> framebuffer <width> <height>
+//   <seconds> computer <cell>
+// Times are seconds since recording started.
+//
+// No GLFW / OpenGL dependency.
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+const int JOURNAL_VERSION = 1;
+
+enum JournalEventType {
+    JOURNAL_CLICK,       // a = cell, -1 outside the board
+    JOURNAL_KEY,         // a = GLFW key code
+    JOURNAL_WINDOW,      // a x b window size in screen coordinates
+    JOURNAL_FRAMEBUFFER, // a x b framebuffer size in pixels
+    JOURNAL_COMPUTER,    // a = cell the computer's search played
+    JOURNAL_TYPES
+};
+
+inline const char* journalEventName(JournalEventType t) {
+    static const char* NAMES[JOURNAL_TYPES] = {"click", "key", "window", "framebuffer", "computer"};
+    return t < JOURNAL_TYPES ? NAMES[t] : "?";
+}
+
+inline bool journalEventHasSize(JournalEventType t) { return t == JOURNAL_WINDOW || t == JOURNAL_FRAMEBUFFER; }
+
+struct JournalEvent {
+    double time = 0.0;
+    JournalEventType type = JOURNAL_CLICK;
+    int a = 0, b = 0;
+};
+
+class InputJournalWriter {
+public:
+    ~InputJournalWriter() { close(); }
+
+    bool open(const std::string& path, int width, int height, int k) {
+        close();
+        f = fopen(path.c_str(), "w");
+        if(!f) return false;
+        fprintf(f, "ttt-input %d %d %d %d\n", JOURNAL_VERSION, width, height, k);
+        return true;
+    }
+
+    bool isOpen() const { return f != nullptr; }
+
+    // buffered by stdio; written out by close()
+    void add(double time, JournalEventType type, int a, int b = 0) {
+        if(!f) return;
+        if(journalEventHasSize(type)) fprintf(f, "%.6f %s %d %d\n", time, journalEventName(type), a, b);
+        else fprintf(f, "%.6f %s %d\n", time, journalEventName(type), a);
+        count++;
+    }
+
+    size_t events() const { return count; }
+
+    void close() {
+        if(f) fclose(f);
+        f = nullptr;
+    }
+
+private:
+    FILE* f = nullptr;
+    size_t count = 0;
+};
+
+// a whole journal in memory, and a cursor for playing it back
+class InputJournal {
+public:
+    bool load(const std::string& path) {
+        FILE* f = fopen(path.c_str(), "r");
+        if(!f) {
+            perror(path.c_str());
+            return false;
+        }
+        list.clear();
+        pos = 0;
+        int version = 0;
+        bool ok = fscanf(f, " ttt-input %d %d %d %d", &version, &w, &h, &k) == 4 && version == JOURNAL_VERSION &&
+                  w >= 1 && h >= 1 && w <= 65535 && h <= 65535;
+        char name[32];
+        JournalEvent e;
+        while(ok && fscanf(f, " %lf %31s %d", &e.time, name, &e.a) == 3) {
+            int t = 0;
+            while(t < JOURNAL_TYPES && strcmp(name, journalEventName((JournalEventType)t)) != 0) t++;
+            e.type = (JournalEventType)t;
+            e.b = 0;
+            ok = t < JOURNAL_TYPES && (!journalEventHasSize(e.type) || fscanf(f, "%d", &e.b) == 1) && valid(e);
+            if(ok) list.push_back(e);
+        }
+        ok = ok && feof(f);
+        fclose(f);
+        if(!ok) fprintf(stderr, "%s: not a version %d input journal, or damaged after %zu events\n",
+                        path.c_str(), JOURNAL_VERSION, list.size());
+        return ok;
+    }
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int inARow() const { return k; }
+    const std::vector<JournalEvent>& events() const { return list; }
+
+    // playback: events are handed out in order by next() / pop()
+    bool done() const { return pos >= list.size(); }
+    const JournalEvent& next() const { return list[pos]; }
+    void pop() { pos++; }
+    size_t played() const { return pos; }
+
+    // the file may have been edited by hand: cells must be on the board,
+    // sizes positive
+    bool valid(const JournalEvent& e) const {
+        long long cells = (long long)w * h;
+        if(e.type == JOURNAL_CLICK) return e.a >= -1 && e.a < cells;
+        if(e.type == JOURNAL_COMPUTER) return e.a >= 0 && e.a < cells;
+        if(journalEventHasSize(e.type)) return e.a > 0 && e.b > 0;
+        return true;
+    }
+
+private:
+    std::vector<JournalEvent> list;
+    size_t pos = 0;
+    int w = 0, h = 0, k = 0;
+};
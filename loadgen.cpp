@@ -0,0 +1,288 @@
+// loadgen.cpp
+// Load generator for game_server: plays thousands of concurrent matches
+// against it and reports matches per second and move round-trip latency.
+//
+// Every pair of connections plays --matches matches at the same time, one
+// socket as X (it creates the matches) and one as O (it joins them); both
+// pick random legal moves. As soon as a match is over the pair starts a new
+// one, so the number of live matches stays at pairs x matches. Pairs are
+// spread over --threads threads, each with its own poll loop, Rng and
+// counters, which are only added together after join() (like simulator).
+//
+// A move's round trip is from queuing the MOVE to reading its MOVED reply;
+// messages queued while handling one batch of replies go out in one send()
+// per socket, so it includes that batching.
+//
+// Usage: loadgen [--host ADDR] [--port P] [--pairs N] [--matches M] [--threads T] [--seconds S] [--seed S]
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "game_state.h"
+#include "match_protocol.h"
+#include "rng.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct LoadStats {
+    uint64_t matches = 0, moves = 0, errors = 0, disconnects = 0;
+    std::vector<float> rttMicros;
+
+    void add(const LoadStats& o) {
+        matches += o.matches; moves += o.moves; errors += o.errors; disconnects += o.disconnects;
+        rttMicros.insert(rttMicros.end(), o.rttMicros.begin(), o.rttMicros.end());
+    }
+};
+
+struct LoadConfig {
+    std::string host = "127.0.0.1";
+    int port = 7777;
+    int pairs = 16;
+    int matchesPerPair = 128;
+    int threads = 1;
+    double seconds = 5.0;
+    uint64_t seed = 1;
+};
+
+int connectTo(const LoadConfig& cfg) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0) return -1;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)cfg.port);
+    if(inet_pton(AF_INET, cfg.host.c_str(), &addr.sin_addr) != 1 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// uniform random empty cell
+int randomMove(const GameState& s, Rng& rng) {
+    uint32_t empty = s.emptyCells();
+    int pick = (int)rng.below((uint32_t)__builtin_popcount(empty));
+    while(pick--) empty &= empty - 1; // drop the lowest set bits
+    return __builtin_ctz(empty);
+}
+
+class LoadWorker {
+public:
+    LoadWorker(const LoadConfig& cfg, int pairCount, uint64_t seed) : cfg(cfg), rng(seed), pairs(pairCount) {}
+
+    bool connectAll() {
+        for(Pair& p : pairs) {
+            for(int side=0;side<2;side++){
+                p.fd[side] = connectTo(cfg);
+                if(p.fd[side] < 0) return false;
+            }
+        }
+        return true;
+    }
+
+    void run(Clock::time_point deadline, LoadStats& out) {
+        for(size_t i=0;i<pairs.size();i++){
+            for(int m=0;m<cfg.matchesPerPair;m++) queue(i, 0, {MSG_CREATE, 0, 0, 0});
+        }
+        flushAll();
+
+        std::vector<pollfd> fds;
+        for(Pair& p : pairs) for(int side=0;side<2;side++) fds.push_back({p.fd[side], POLLIN, 0});
+        unsigned char buf[65536];
+        while(Clock::now() < deadline) {
+            int n = poll(fds.data(), fds.size(), 100);
+            if(n < 0 && errno != EINTR) break;
+            for(size_t i=0;i<fds.size() && n > 0;i++){
+                if(!fds[i].revents) continue;
+                n--;
+                size_t pair = i / 2;
+                int side = (int)(i % 2);
+                ssize_t got = recv(fds[i].fd, buf, sizeof(buf), MSG_DONTWAIT);
+                if(got <= 0) {
+                    if(got < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+                    stats.disconnects++;
+                    fds[i].fd = -1; // poll skips it from now on
+                    continue;
+                }
+                std::vector<unsigned char>& in = pairs[pair].in[side];
+                in.insert(in.end(), buf, buf + got);
+                size_t used = 0;
+                for(;in.size() - used >= (size_t)MSG_SIZE;used+=MSG_SIZE) handle(pair, side, decodeMsg(&in[used]));
+                in.erase(in.begin(), in.begin() + used);
+            }
+            flushAll();
+        }
+        for(Pair& p : pairs) for(int side=0;side<2;side++) if(p.fd[side] >= 0) close(p.fd[side]);
+        out = std::move(stats);
+    }
+
+private:
+    struct Pair {
+        int fd[2] = {-1, -1}; // X, O
+        std::vector<unsigned char> in[2], out[2];
+    };
+    struct ClientMatch {
+        GameState state;
+        Clock::time_point sentAt[2]; // per side: its MOVE may still be in flight when the other moves
+    };
+
+    LoadConfig cfg;
+    Rng rng;
+    std::vector<Pair> pairs;
+    std::unordered_map<uint32_t, ClientMatch> matches;
+    LoadStats stats;
+
+    void queue(size_t pair, int side, const Msg& m) {
+        std::vector<unsigned char>& out = pairs[pair].out[side];
+        size_t at = out.size();
+        out.resize(at + MSG_SIZE);
+        encodeMsg(m, &out[at]);
+    }
+
+    void flushAll() {
+        for(Pair& p : pairs) {
+            for(int side=0;side<2;side++){
+                std::vector<unsigned char>& out = p.out[side];
+                size_t sent = 0;
+                while(sent < out.size()) {
+                    ssize_t n = send(p.fd[side], out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+                    if(n < 0 && errno == EINTR) continue;
+                    if(n <= 0) break;
+                    sent += (size_t)n;
+                }
+                out.clear();
+            }
+        }
+    }
+
+    void move(size_t pair, int side, uint32_t id, ClientMatch& m) {
+        m.sentAt[side] = Clock::now();
+        queue(pair, side, {MSG_MOVE, 0, (uint16_t)randomMove(m.state, rng), id});
+    }
+
+    void handle(size_t pair, int side, const Msg& msg) {
+        switch(msg.type) {
+        case MSG_CREATED:
+            matches[msg.match] = ClientMatch();
+            queue(pair, 1, {MSG_JOIN, 0, 0, msg.match});
+            break;
+        case MSG_OPPONENT_JOINED: { // X moves first
+            auto it = matches.find(msg.match);
+            if(it != matches.end()) move(pair, 0, msg.match, it->second);
+            break;
+        }
+        case MSG_MOVED: {
+            auto it = matches.find(msg.match);
+            if(it == matches.end()) break;
+            double micros = std::chrono::duration<double, std::micro>(Clock::now() - it->second.sentAt[side]).count();
+            stats.rttMicros.push_back((float)micros);
+            stats.moves++;
+            it->second.state.play(msg.cell, side == 0 ? 1 : -1);
+            if(msg.value != 0) {
+                stats.matches++;
+                matches.erase(it);
+                queue(pair, 0, {MSG_CREATE, 0, 0, 0}); // keep the number of live matches up
+            }
+            break;
+        }
+        case MSG_OPPONENT_MOVED: {
+            // may arrive before or after the mover's MOVED; play() is idempotent
+            auto it = matches.find(msg.match);
+            if(it == matches.end()) break;
+            it->second.state.play(msg.cell, side == 0 ? -1 : 1);
+            if(msg.value == 0) move(pair, side, msg.match, it->second);
+            break;
+        }
+        case MSG_OPPONENT_LEFT:
+            matches.erase(msg.match);
+            break;
+        case MSG_ERROR:
+            if(stats.errors++ < 5) fprintf(stderr, "server error %d for match %u\n", msg.value, msg.match);
+            break;
+        default:
+            break;
+        }
+    }
+};
+
+float percentile(const std::vector<float>& sorted, double p) {
+    if(sorted.empty()) return 0.0f;
+    size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+int main(int argc, char** argv) {
+    LoadConfig cfg;
+    for(int i=1;i<argc;i++){
+        std::string arg = argv[i];
+        bool hasValue = i+1 < argc;
+        if(arg == "--host" && hasValue) cfg.host = argv[++i];
+        else if(arg == "--port" && hasValue) cfg.port = atoi(argv[++i]);
+        else if(arg == "--pairs" && hasValue) cfg.pairs = atoi(argv[++i]);
+        else if(arg == "--matches" && hasValue) cfg.matchesPerPair = atoi(argv[++i]);
+        else if(arg == "--threads" && hasValue) cfg.threads = atoi(argv[++i]);
+        else if(arg == "--seconds" && hasValue) cfg.seconds = atof(argv[++i]);
+        else if(arg == "--seed" && hasValue) cfg.seed = strtoull(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "Usage: %s [--host ADDR] [--port P] [--pairs N] [--matches M] [--threads T] [--seconds S] [--seed S]\n"
+                            "  --pairs    connection pairs (X + O socket), default 16\n"
+                            "  --matches  concurrent matches per pair, default 128\n", argv[0]);
+            return 1;
+        }
+    }
+    if(cfg.pairs < 1) cfg.pairs = 1;
+    if(cfg.matchesPerPair < 1) cfg.matchesPerPair = 1;
+    if(cfg.threads < 1) cfg.threads = 1;
+    if(cfg.threads > cfg.pairs) cfg.threads = cfg.pairs;
+
+    std::vector<LoadWorker> workers;
+    for(int t=0;t<cfg.threads;t++){
+        int count = cfg.pairs / cfg.threads + (t < cfg.pairs % cfg.threads ? 1 : 0);
+        workers.emplace_back(cfg, count, cfg.seed + t);
+    }
+    for(LoadWorker& w : workers) {
+        if(!w.connectAll()) {
+            fprintf(stderr, "cannot connect to %s:%d\n", cfg.host.c_str(), cfg.port);
+            return 1;
+        }
+    }
+
+    std::vector<LoadStats> shards(cfg.threads);
+    std::vector<std::thread> pool;
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(cfg.seconds));
+    for(int t=0;t<cfg.threads;t++) pool.emplace_back(&LoadWorker::run, &workers[t], deadline, std::ref(shards[t]));
+    for(auto& th : pool) th.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    LoadStats total;
+    for(const LoadStats& s : shards) total.add(s);
+    std::sort(total.rttMicros.begin(), total.rttMicros.end());
+
+    printf("%s:%d, %d pairs x %d matches = %d concurrent matches, %d threads, %.1fs\n",
+           cfg.host.c_str(), cfg.port, cfg.pairs, cfg.matchesPerPair, cfg.pairs * cfg.matchesPerPair, cfg.threads, seconds);
+    printf("  matches: %10llu (%.0f/s)\n", (unsigned long long)total.matches, total.matches / seconds);
+    printf("  moves:   %10llu (%.0f/s)\n", (unsigned long long)total.moves, total.moves / seconds);
+    printf("  move round trip us: p50 %.0f  p90 %.0f  p99 %.0f  p99.9 %.0f  max %.0f\n",
+           percentile(total.rttMicros, 0.50), percentile(total.rttMicros, 0.90), percentile(total.rttMicros, 0.99),
+           percentile(total.rttMicros, 0.999), total.rttMicros.empty() ? 0.0f : total.rttMicros.back());
+    if(total.errors || total.disconnects)
+        printf("  errors: %llu, disconnects: %llu\n", (unsigned long long)total.errors, (unsigned long long)total.disconnects);
+    return total.errors || total.disconnects ? 1 : 0;
+}
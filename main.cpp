@@ -1,214 +1,646 @@
 // tictactoe_opengl.cpp
-// Simple Tic-Tac-Toe (Three-in-a-row) using GLFW + OpenGL immediate mode.
+// Simple Tic-Tac-Toe (Three-in-a-row) using GLFW + OpenGL 3.3 core profile.
+// Rendering lives in board_renderer.h (shaders/board_sdf.*, shaders/board.*).
+//
+// Usage: ttt [width height k] [--think seconds] [--threads n] [--tree-mb MB]
+//            [--continuous] [--hot-reload] [--vsync on|off] [--fps N] [--overlay] [--csv file]
+//            [--low-latency] [--record file] [--replay file [--game n]] [--heatmap]
+//            [--heat-time seconds] [--db file] [--record-input file]
+//            [--play-input file [--input-speed recorded|max] [--headless]] [--trace file]
+//   default board is 3 3 3, e.g. "ttt 15 15 5" for gomoku
+//
+// Frames are only drawn after something changed (input, resize, computer
+// move); the loop sleeps in glfwWaitEvents otherwise. --continuous restores
+// redrawing every iteration, for comparing CPU/GPU load. --hot-reload
+// reloads shaders/board.* when they are saved (shader_cache.h).
+//
+// Frame pacing (frame_timing.h): --vsync off disables waiting for the
+// display, --fps N caps the frame rate with an adaptive sleep (0 = no cap).
+// Every frame records CPU time, GPU time (timer queries), frame interval,
+// draw calls and vertices; --overlay shows them in the window and --csv
+// writes one line per frame to a file at exit. In the default mode the
+// overlay only changes when a frame is drawn, use --continuous for live
+// numbers.
+//
+// Input latency: a click or key press that changes the picture is followed
+// through the state update, draw submission, swap and GPU completion (a
+// fence wait after that frame's swap); the overlay shows the last sample,
+// the CSV has it per frame and a summary is printed at exit. --low-latency
+// samples input right before rendering (after the frame cap sleep, not
+// before it) and waits for the GPU after every swap, so the driver never
+// queues frames ahead of the display. Cursor position and window sizes are
+// always taken from callbacks instead of being queried per click/frame.
+//
+// --record appends every finished game to a record file (game_record.h,
+// the format simulator and game_server write too). --replay steps through
+// the games of such a file instead of playing: Right / Left move forward /
+// back, Home / End jump to the start / end, Page Down / Page Up (or N / P)
+// go to the next / previous game; the title bar shows where you are.
+//
+// The heatmap (M, or --heatmap) shades every empty cell by what playing
+// there is worth for the side to move: red loss, yellow draw, green win.
+// It is computed by a worker thread (heatmap.h): exact from the outcome
+// table on 3x3, MCTS win rates that sharpen over --heat-time seconds
+// (default 2) on bigger boards. Every board change cancels the running
+// evaluation and starts a new one; the loop only picks up finished results
+// from a lock-free slot, so rendering never waits for it.
+//
+// --db maps a position table made by position_db_gen (position_db.h) for
+// the same board size. Wherever it covers the position, the computer, the
+// hint and the heatmap use its exact values, one lookup per move, instead
+// of searching; only the pages lookups touch are read from disk.
+//
+// --record-input journals every click (as the cell it hit), key press,
+// window / framebuffer resize and MCTS move with its time (input_journal.h);
+// --play-input feeds such a journal back instead of live input, on the
+// board it was recorded on, so the same session can be profiled run after
+// run. --input-speed recorded (default) keeps the original timing, max
+// feeds the next event as soon as the previous one has been drawn (still
+// waiting for each MCTS search to finish). --headless plays it back in a
+// hidden window. Live input is ignored during playback, except Esc; the
+// window closes once the journal is played.
+//
+// --trace writes the profiler.h zones (rendering, buffer uploads, shader
+// compilation, input handling, the MCTS and heatmap threads) to a Chrome
+// trace JSON file at exit, for chrome://tracing or ui.perfetto.dev. The
+// zones are only compiled in with -DPROFILER_ENABLED.
 //
 // Controls:
 //  - Click on a cell to place X or O (X goes first).
+//  - Press C to toggle the computer opponent (plays O). 3x3 uses the outcome
+//    table, --db positions the position table, anything else runs a
+//    multithreaded MCTS search on a worker thread.
+//  - Press H to toggle the best-move hint (3x3 and --db positions only).
+//  - Press M to toggle the move-evaluation heatmap.
 //  - Press R to restart.
+//  - Press F to toggle the timing overlay, V to toggle vsync.
 //  - Press Esc to quit.
 
+#include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <cstdlib>
 #include <cstdio>
 #include <cmath>
 #include <array>
 #include <string>
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include "board.h"
+#include "outcome_table.h"
+#include "mcts.h"
+#include "board_renderer.h"
+#include "debug_overlay.h"
+#include "frame_timing.h"
+#include "game_record.h"
+#include "heatmap.h"
+#include "input_journal.h"
+#include "position_db.h"
+#include "profiler.h"
 
 const int WIN_W = 600;
 const int WIN_H = 600;
 
-int board[9]; // 0 empty, 1 = X, -1 = O
+Board board; // width x height cells, k in a row
 int currentPlayer = 1; // 1 => X, -1 => O
 bool gameOver = false;
 int winner = 0; // 0 none, 1 X, -1 O, 2 draw
+bool computerPlaysO = false;
+bool showHint = false;
+bool showHeatmap = false;
+BoardRenderer renderer;
+DebugOverlay overlay;
+
+bool needsRedraw = true;     // set whenever the picture changes
+bool continuousRedraw = false;
+bool hotReload = false;
+const double THINKING_TICK = 1.0 / 30.0; // how often to check on the computer
+const double SHADER_POLL_TICK = 0.25;    // how often to look for edited shaders
+const int MAX_TREE_MB = 1 << 16;         // --tree-mb, 64 GB
+
+bool vsync = true;
+bool showOverlay = false;
+bool lowLatency = false;
+FrameLimiter limiter;
+GpuTimer gpuTimer;
+LatencyTracker latency;
+
+// kept up to date by the callbacks
+double cursorX = 0.0, cursorY = 0.0;
+int windowW = WIN_W, windowH = WIN_H;
+int framebufferW = WIN_W, framebufferH = WIN_H;
+
+double inputTime = -1.0; // while an input callback runs: when it started
+
+std::vector<int> moveHistory; // cells of the current game, in order
+GameRecordWriter recordFile;
+GameRecordBlock recordBlock;
+
+bool replaying = false;
+GameRecordReader replayFile;
+uint64_t replayGame = 0; // game shown, 0-based
+int replayMove = 0;      // moves of it on the board
+GameView replayView;
+
+uint64_t boardVersion = 0; // bumped on every change to `board`
+
+PositionDb positionDb; // --db, exact values for the positions it covers
+
+HeatmapWorker heatmapWorker;
+double heatmapBudget = 2.0;    // seconds of MCTS per position on big boards
+Heatmap heatmap;               // newest result taken from the worker
+uint64_t heatmapRequested = 0; // generation of the last request, 0 for none
+uint64_t heatmapBoard = 0;     // boardVersion it was requested for
+uint64_t heatmapShown = 0;     // bumped whenever `heatmap` changes, for the renderer
+
+InputJournalWriter inputRecord; // --record-input
+InputJournal inputPlayback;     // --play-input
+bool playingInput = false;
+bool inputMaxSpeed = false;     // --input-speed max
+double journalStart = 0.0;      // glfwGetTime() when recording / playback started
+
+double journalTime() { return glfwGetTime() - journalStart; }
+
+void markDirty() {
+    needsRedraw = true;
+    if(inputTime >= 0.0) latency.input(inputTime, glfwGetTime());
+}
+
+MctsConfig mctsConfig;                // time budget / threads for big boards
+MctsSearcher computerSearcher;        // its node pools are reused move after move
+std::future<MctsResult> computerSearch; // valid while the computer is thinking
+std::atomic<bool> cancelSearch(false);
+
+bool computerThinking() { return computerSearch.valid(); }
+
+// stop a running search and drop its result
+void cancelComputerMove() {
+    if(!computerThinking()) return;
+    cancelSearch = true;
+    computerSearch.get();
+}
 
 void resetGame() {
-    for(int i=0;i<9;i++) board[i] = 0;
+    cancelComputerMove();
+    board.reset();
+    boardVersion++;
+    moveHistory.clear();
     currentPlayer = 1;
     gameOver = false;
     winner = 0;
+    markDirty();
 }
 
 int checkWinner() {
-    // rows, cols, diagonals
-    const int lines[8][3] = {
-        {0,1,2},{3,4,5},{6,7,8},
-        {0,3,6},{1,4,7},{2,5,8},
-        {0,4,8},{2,4,6}
-    };
-    for(int i=0;i<8;i++){
-        int a=lines[i][0], b=lines[i][1], c=lines[i][2];
-        int sum = board[a] + board[b] + board[c];
-        if(sum == 3) return 1;
-        if(sum == -3) return -1;
+    PROFILE_FUNCTION();
+    // 0 none, 1 X, -1 O, 2 draw
+    return board.result();
+}
+
+void renderBoard(int w, int h) {
+    PROFILE_FUNCTION();
+    BoardScene scene;
+    scene.board = &board;
+    scene.currentPlayer = currentPlayer;
+    scene.gameOver = gameOver;
+    scene.winner = winner;
+    // hint: shade the best cell for the player to move
+    if(showHint && !gameOver && board.isClassic())
+        scene.hintCell = bestMoveFromTable(toGameState(board));
+    else if(showHint && !gameOver && positionDb.covers(board))
+        scene.hintCell = positionDb.bestMove(board);
+    if(showHeatmap && heatmap.generation == heatmapRequested && (int)heatmap.value.size() == board.size()) {
+        scene.heat = heatmap.value.data();
+        scene.heatVersion = heatmapShown;
     }
-    // check draw
-    bool anyEmpty=false;
-    for(int i=0;i<9;i++) if(board[i]==0) { anyEmpty=true; break; }
-    if(!anyEmpty) return 2; // draw
-    return 0;
+    drawBoardFrame(renderer, scene, w, h);
 }
 
-void drawLine(float x1, float y1, float x2, float y2, float w=6.0f) {
-    glLineWidth(w);
-    glBegin(GL_LINES);
-    glVertex2f(x1,y1);
-    glVertex2f(x2,y2);
-    glEnd();
+// convert window coords to board cell index, return -1 if out
+int windowCoordsToCell(double mx, double my, int w, int h) {
+    if(w <= 0 || h <= 0) return -1; // minimized
+    // window Y already grows downward like the row index
+    int col = (int)floor(mx / w * board.width());
+    int row = (int)floor(my / h * board.height());
+    if(col<0 || col>=board.width() || row<0 || row>=board.height()) return -1;
+    return row*board.width() + col;
 }
 
-// draw X inside cell centered at (cx,cy) with half-size hs
-void drawX(float cx, float cy, float hs) {
-    glLineWidth(8.0f);
-    glBegin(GL_LINES);
-      glVertex2f(cx - hs, cy - hs);
-      glVertex2f(cx + hs, cy + hs);
-      glVertex2f(cx - hs, cy + hs);
-      glVertex2f(cx + hs, cy - hs);
-    glEnd();
+// place currentPlayer's piece on an empty cell and advance the game
+void placePiece(int idx) {
+    board.play(idx, currentPlayer);
+    boardVersion++;
+    moveHistory.push_back(idx);
+    markDirty();
+    int cw = checkWinner();
+    if(cw != 0) {
+        gameOver = true;
+        winner = cw;
+        if(recordFile.isOpen()) {
+            recordBlock.add(moveHistory.data(), (int)moveHistory.size(), cw);
+            recordFile.append(recordBlock);
+        }
+    } else {
+        currentPlayer = -currentPlayer;
+    }
 }
 
-// draw O inside cell centered at (cx,cy) with radius r
-void drawO(float cx, float cy, float r) {
-    glLineWidth(8.0f);
-    glBegin(GL_LINE_STRIP);
-    const int SEG = 40;
-    for(int i=0;i<=SEG;i++){
-        float a = (float)i / (float)SEG * 2.0f * 3.1415926f;
-        glVertex2f(cx + cosf(a)*r, cy + sinf(a)*r);
+// answer when it is the computer's turn: table lookup on 3x3 and for
+// positions the --db table covers, otherwise start an MCTS search on a
+// worker thread (picked up by pollComputerMove)
+void computerMove() {
+    PROFILE_FUNCTION();
+    if(!computerPlaysO || gameOver || currentPlayer != -1 || computerThinking()) return;
+    if(board.isClassic()) {
+        int idx = bestMoveFromTable(toGameState(board));
+        if(idx >= 0) placePiece(idx);
+        return;
     }
-    glEnd();
+    if(positionDb.covers(board)) {
+        int idx = positionDb.bestMove(board);
+        if(idx >= 0) placePiece(idx);
+        return;
+    }
+    cancelSearch = false;
+    mctsConfig.cancel = &cancelSearch;
+    computerSearch = std::async(std::launch::async, [](Board b, MctsConfig cfg) {
+                                    PROFILE_THREAD("computer");
+                                    return computerSearcher.search(b, cfg);
+                                },
+                                board, mctsConfig);
 }
 
-void renderBoard(int w, int h) {
-    // set up orthographic coords from -1..1 both axes
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glOrtho(-1,1,-1,1,-1,1);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-
-    // Clear background is done outside
-
-    // draw grid lines (two vertical, two horizontal)
-    glColor3f(0.15f, 0.15f, 0.15f);
-    // vertical lines at x = -1/3, 1/3
-    drawLine(-1.0f/3.0f, -1.0f, -1.0f/3.0f, 1.0f, 8.0f);
-    drawLine( 1.0f/3.0f, -1.0f,  1.0f/3.0f, 1.0f, 8.0f);
-    // horizontal lines at y = -1/3, 1/3
-    drawLine(-1.0f, -1.0f/3.0f, 1.0f, -1.0f/3.0f, 8.0f);
-    drawLine(-1.0f,  1.0f/3.0f, 1.0f,  1.0f/3.0f, 8.0f);
-
-    // draw X and O
-    for(int r=0;r<3;r++){
-        for(int c=0;c<3;c++){
-            int idx = r*3 + c;
-            int val = board[idx];
-            // compute center coordinates
-            float cellW = 2.0f/3.0f;
-            float cx = -1.0f + cellW*(c+0.5f);
-            float cy =  1.0f - cellW*(r+0.5f); // note: screen Y downward -> invert
-            if(val == 1) {
-                glColor3f(0.9f, 0.2f, 0.2f); // X color
-                drawX(cx, cy, cellW*0.28f);
-            } else if(val == -1) {
-                glColor3f(0.12f, 0.2f, 0.9f); // O color
-                drawO(cx, cy, cellW*0.28f);
-            }
-        }
+bool computerSearchDone() {
+    return computerSearch.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// wait for the running search and print its numbers
+MctsResult takeComputerSearch() {
+    MctsResult r = computerSearch.get();
+    printf("MCTS: %llu playouts in %.2fs on %d threads (%.0f playouts/s), %llu nodes in %.1f of %.0f MB%s\n",
+           (unsigned long long)r.playouts, r.seconds, r.threads, r.playoutsPerSecond(), (unsigned long long)r.nodes,
+           r.treeBytes / 1048576.0, r.poolBytes / 1048576.0, r.treeFull ? " (full)" : "");
+    return r;
+}
+
+// called every frame: play the computer's move once the search is done
+// (during --play-input the journal has the move, see playJournal())
+void pollComputerMove() {
+    if(!computerThinking() || playingInput || !computerSearchDone()) return;
+    MctsResult r = takeComputerSearch();
+    if(computerPlaysO && r.move >= 0 && !gameOver && board.isEmpty(r.move)) {
+        inputRecord.add(journalTime(), JOURNAL_COMPUTER, r.move);
+        placePiece(r.move);
     }
+}
 
-    // If game over, draw a translucent overlay and text-like indicator using colored rectangle lines
-    if(gameOver) {
-        // darken screen
-        glColor4f(0.0f,0.0f,0.0f,0.35f);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glBegin(GL_QUADS);
-          glVertex2f(-1,-1); glVertex2f(1,-1);
-          glVertex2f(1,1);  glVertex2f(-1,1);
-        glEnd();
-        glDisable(GL_BLEND);
-
-        // draw winner line or message: for simplicity, draw the winning triple line if any
-        if(winner == 1 || winner == -1) {
-            // Find the winning line again and draw a thicker colored line across the centers of the cells
-            const int lines[8][3] = {
-                {0,1,2},{3,4,5},{6,7,8},
-                {0,3,6},{1,4,7},{2,5,8},
-                {0,4,8},{2,4,6}
-            };
-            for(int i=0;i<8;i++){
-                int a=lines[i][0], b=lines[i][1], c=lines[i][2];
-                int sum = board[a]+board[b]+board[c];
-                if(sum == 3*winner){
-                    // compute center pos of cell a and c to draw a line across
-                    int ra = a/3, ca = a%3;
-                    int rc = c/3, cc = c%3;
-                    float cellW = 2.0f/3.0f;
-                    float cxa = -1.0f + cellW*(ca+0.5f);
-                    float cya =  1.0f - cellW*(ra+0.5f);
-                    float cxc = -1.0f + cellW*(cc+0.5f);
-                    float cyc =  1.0f - cellW*(rc+0.5f);
-                    if(winner==1) glColor3f(1.0f,0.7f,0.2f); else glColor3f(0.2f,0.9f,0.7f);
-                    drawLine(cxa,cya,cxc,cyc, 10.0f);
-                    break;
-                }
-            }
+// --- heatmap ---
+
+// called every frame: restart the worker when the board changed and pick
+// up whatever it has published since
+void pollHeatmap() {
+    if(!showHeatmap) {
+        if(heatmapRequested) heatmapWorker.abandon();
+        heatmapRequested = 0;
+        return;
+    }
+    if(heatmapRequested == 0 || heatmapBoard != boardVersion) {
+        heatmapRequested = heatmapWorker.request(board);
+        heatmapBoard = boardVersion;
+    }
+    if(heatmapWorker.take(heatmap) && heatmap.generation == heatmapRequested) {
+        heatmapShown++;
+        needsRedraw = true;
+    }
+}
+
+// still waiting for (more) results for the current board
+bool heatmapPending() {
+    return showHeatmap && !(heatmap.generation == heatmapRequested && heatmap.final);
+}
+
+// --- replay ---
+
+// a board size the game can be played on (the command line, a record or a
+// journal may ask for any)
+bool playableBoard(int w, int h, int k) {
+    return w >= 1 && h >= 1 && k >= 1 && (k <= w || k <= h) && w * h <= MCTS_MAX_CELLS;
+}
+
+// the first replayMove moves of the current replay game
+void showReplayPosition(GLFWwindow* win) {
+    board.reset();
+    for(int i=0;i<replayMove;i++) board.play(replayView.move(i), (i & 1) ? -1 : 1);
+    boardVersion++;
+    currentPlayer = board.sideToMove();
+    winner = board.result();
+    gameOver = winner != 0;
+    markDirty();
+    char title[128];
+    snprintf(title, sizeof(title), "Three in a Row - replay: game %llu / %llu, move %d / %d",
+             (unsigned long long)replayGame + 1, (unsigned long long)replayFile.games(), replayMove, replayView.moveCount);
+    glfwSetWindowTitle(win, title);
+}
+
+bool loadReplayGame(GLFWwindow* win, uint64_t n) {
+    GameView g;
+    if(n >= replayFile.games() || !replayFile.game(n, g)) return false;
+    // a damaged or foreign file may hold cells off the board or repeated ones
+    Board check(board.width(), board.height(), board.inARow());
+    for(int i=0;i<g.moveCount;i++){
+        int cell = g.move(i);
+        if(cell >= check.size() || !check.isEmpty(cell)) {
+            fprintf(stderr, "replay game %llu: move %d is not on an empty cell\n", (unsigned long long)n + 1, i + 1);
+            return false;
         }
+        check.play(cell, (i & 1) ? -1 : 1);
     }
+    replayView = g;
+    replayGame = n;
+    replayMove = 0;
+    showReplayPosition(win);
+    return true;
 }
 
-// convert window coords to board cell index, return -1 if out
-int windowCoordsToCell(double mx, double my, int w, int h) {
-    // normalize to -1..1 with origin bottom-left for OpenGL coordinate used above
-    float nx = (float)(mx / w) * 2.0f - 1.0f;
-    float ny = -((float)(my / h) * 2.0f - 1.0f); // invert y
-    // each cell occupies -1..1 divided in 3 parts (cell width = 2/3)
-    float cellW = 2.0f/3.0f;
-    int col = (int)floor((nx + 1.0f) / cellW);
-    int row = (int)floor((1.0f - ny) / cellW); // careful with inversion
-    if(col<0 || col>2 || row<0 || row>2) return -1;
-    return row*3 + col;
+void handleReplayKey(GLFWwindow* win, int key) {
+    if(key == GLFW_KEY_RIGHT && replayMove < replayView.moveCount) replayMove++;
+    else if(key == GLFW_KEY_LEFT && replayMove > 0) replayMove--;
+    else if(key == GLFW_KEY_HOME || key == GLFW_KEY_R) replayMove = 0;
+    else if(key == GLFW_KEY_END) replayMove = replayView.moveCount;
+    else if(key == GLFW_KEY_PAGE_DOWN || key == GLFW_KEY_N) { loadReplayGame(win, replayGame + 1); return; }
+    else if((key == GLFW_KEY_PAGE_UP || key == GLFW_KEY_P) && replayGame > 0) { loadReplayGame(win, replayGame - 1); return; }
+    else return;
+    showReplayPosition(win);
 }
 
-void mouseButtonCallback(GLFWwindow* win, int button, int action, int mods) {
-    if(button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS) return;
+// a click on cell idx, -1 outside the board
+void handleClick(int idx) {
+    if(replaying) return;
     if(gameOver) return; // ignore clicks after game over (press R to restart)
-    double mx, my;
-    int w,h;
-    glfwGetCursorPos(win, &mx, &my);
-    glfwGetWindowSize(win, &w, &h);
-    int idx = windowCoordsToCell(mx,my,w,h);
-    if(idx >= 0 && idx < 9 && board[idx] == 0) {
-        board[idx] = currentPlayer;
-        int cw = checkWinner();
-        if(cw != 0) {
-            gameOver = true;
-            winner = cw;
-        } else {
-            currentPlayer = -currentPlayer;
-        }
+    if(computerPlaysO && currentPlayer == -1) return; // computer's turn
+    if(computerThinking()) return;
+    if(idx >= 0 && board.isEmpty(idx)) {
+        placePiece(idx);
+        computerMove();
     }
 }
 
-void keyCallback(GLFWwindow* win, int key, int scancode, int action, int mods) {
-    if(action != GLFW_PRESS) return;
-    if(key == GLFW_KEY_R) {
+void mouseButtonCallback(GLFWwindow* win, int button, int action, int mods) {
+    if(button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS || playingInput) return;
+    PROFILE_FUNCTION();
+    inputTime = glfwGetTime();
+    int idx = windowCoordsToCell(cursorX,cursorY,windowW,windowH);
+    inputRecord.add(journalTime(), JOURNAL_CLICK, idx);
+    handleClick(idx);
+    inputTime = -1.0;
+}
+
+void cursorPosCallback(GLFWwindow* win, double x, double y) {
+    cursorX = x;
+    cursorY = y;
+}
+
+void handleKey(GLFWwindow* win, int key) {
+    if(replaying && key != GLFW_KEY_H && key != GLFW_KEY_M && key != GLFW_KEY_F && key != GLFW_KEY_V && key != GLFW_KEY_ESCAPE) {
+        handleReplayKey(win, key);
+    } else if(key == GLFW_KEY_R) {
         resetGame();
+    } else if(key == GLFW_KEY_H) {
+        showHint = !showHint;
+        markDirty();
+    } else if(key == GLFW_KEY_M) {
+        showHeatmap = !showHeatmap;
+        markDirty();
+    } else if(key == GLFW_KEY_C) {
+        computerPlaysO = !computerPlaysO;
+        if(!computerPlaysO) cancelComputerMove(); // the user plays O again
+        computerMove();
+        markDirty();
+    } else if(key == GLFW_KEY_F) {
+        showOverlay = !showOverlay;
+        markDirty();
+    } else if(key == GLFW_KEY_V) {
+        vsync = !vsync;
+        glfwSwapInterval(vsync ? 1 : 0);
+        markDirty();
     } else if(key == GLFW_KEY_ESCAPE) {
         glfwSetWindowShouldClose(win, GLFW_TRUE);
     }
 }
 
-int main() {
+void keyCallback(GLFWwindow* win, int key, int scancode, int action, int mods) {
+    if(action != GLFW_PRESS) return;
+    if(playingInput && key != GLFW_KEY_ESCAPE) return;
+    PROFILE_FUNCTION();
+    inputTime = glfwGetTime();
+    inputRecord.add(journalTime(), JOURNAL_KEY, key);
+    handleKey(win, key);
+    inputTime = -1.0;
+}
+
+// block until the GPU has finished everything submitted so far
+double waitForGpu() {
+    PROFILE_FUNCTION();
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull); // 1 s
+    glDeleteSync(fence);
+    return glfwGetTime();
+}
+
+// one line per counter, smoothed so the numbers are readable
+void drawOverlay(const FrameLog& log, int w, int h) {
+    char line[64];
+    std::vector<std::string> lines;
+    double frameMs = log.frameMs();
+    snprintf(line, sizeof(line), "fps   %.1f", frameMs > 0.0 ? 1000.0 / frameMs : 0.0);   lines.push_back(line);
+    snprintf(line, sizeof(line), "frame %.2f ms", frameMs);                              lines.push_back(line);
+    snprintf(line, sizeof(line), "cpu   %.2f ms", log.cpuMs());                          lines.push_back(line);
+    snprintf(line, sizeof(line), "gpu   %.2f ms", log.gpuMs());                          lines.push_back(line);
+    snprintf(line, sizeof(line), "draws %zu", log.latest().drawCalls);                   lines.push_back(line);
+    snprintf(line, sizeof(line), "verts %zu", log.latest().vertices);                    lines.push_back(line);
+    snprintf(line, sizeof(line), "input %.2f ms", latency.latest().totalMs());          lines.push_back(line);
+    snprintf(line, sizeof(line), "vsync %s cap %.0f%s", vsync ? "on" : "off", limiter.fps(), lowLatency ? " low lat" : "");
+    lines.push_back(line);
+    overlay.draw(lines, w, h, h >= 1200 ? 4 : 2);
+}
+
+void framebufferSizeCallback(GLFWwindow* win, int w, int h) {
+    framebufferW = w;
+    framebufferH = h;
+    inputRecord.add(journalTime(), JOURNAL_FRAMEBUFFER, w, h);
+    markDirty();
+}
+
+void windowSizeCallback(GLFWwindow* win, int w, int h) {
+    windowW = w;
+    windowH = h;
+    inputRecord.add(journalTime(), JOURNAL_WINDOW, w, h);
+}
+
+void windowRefreshCallback(GLFWwindow* win) {
+    markDirty();
+}
+
+// --- input journal playback ---
+
+// seconds until the next journaled event is due: 0 now, -1 never (played
+// to the end, or a computer move whose search is still running)
+double journalWait() {
+    if(!playingInput || inputPlayback.done()) return -1.0;
+    const JournalEvent& e = inputPlayback.next();
+    if(e.type == JOURNAL_COMPUTER && computerThinking() && !computerSearchDone()) return -1.0;
+    if(inputMaxSpeed) return 0.0;
+    return std::max(0.0, e.time - journalTime());
+}
+
+// called every frame: feed the events that are due, one per frame at
+// --input-speed max, and close the window after the last one
+void playJournal(GLFWwindow* win) {
+    PROFILE_FUNCTION();
+    while(journalWait() == 0.0) {
+        JournalEvent e = inputPlayback.next();
+        inputPlayback.pop();
+        inputTime = glfwGetTime();
+        if(e.type == JOURNAL_CLICK) handleClick(e.a);
+        else if(e.type == JOURNAL_KEY) handleKey(win, e.a);
+        else if(e.type == JOURNAL_WINDOW) {
+            glfwSetWindowSize(win, e.a, e.b);
+            windowW = e.a;
+            windowH = e.b;
+        } else if(e.type == JOURNAL_FRAMEBUFFER) {
+            framebufferW = e.a;
+            framebufferH = e.b;
+            markDirty();
+        } else if(e.type == JOURNAL_COMPUTER) {
+            if(computerThinking()) takeComputerSearch(); // the search ran its course, its move is not used
+            if(!gameOver && board.isEmpty(e.a)) placePiece(e.a);
+        }
+        inputTime = -1.0;
+        if(inputMaxSpeed) break;
+    }
+    if(playingInput && inputPlayback.done()) glfwSetWindowShouldClose(win, GLFW_TRUE);
+}
+
+int main(int argc, char** argv) {
+    int dims[3], numDims = 0;
+    double targetFps = 0.0;
+    std::string csvPath, recordPath, replayPath, dbPath, recordInputPath, playInputPath, tracePath;
+    bool headless = false;
+    uint64_t firstReplayGame = 0;
+    for(int i=1;i<argc;i++){
+        std::string arg = argv[i];
+        if(arg == "--think" && i+1 < argc) mctsConfig.timeBudget = atof(argv[++i]);
+        else if(arg == "--threads" && i+1 < argc) mctsConfig.threads = atoi(argv[++i]);
+        else if(arg == "--tree-mb" && i+1 < argc) {
+            int mb = atoi(argv[++i]);
+            if(mb < 1 || mb > MAX_TREE_MB) { numDims = -1; break; }
+            mctsConfig.treeBytes = (size_t)mb << 20;
+        }
+        else if(arg == "--continuous") continuousRedraw = true;
+        else if(arg == "--hot-reload") hotReload = true;
+        else if(arg == "--vsync" && i+1 < argc) vsync = std::string(argv[++i]) != "off";
+        else if(arg == "--fps" && i+1 < argc) targetFps = atof(argv[++i]);
+        else if(arg == "--overlay") showOverlay = true;
+        else if(arg == "--csv" && i+1 < argc) csvPath = argv[++i];
+        else if(arg == "--low-latency") lowLatency = true;
+        else if(arg == "--record" && i+1 < argc) recordPath = argv[++i];
+        else if(arg == "--replay" && i+1 < argc) replayPath = argv[++i];
+        else if(arg == "--game" && i+1 < argc) firstReplayGame = strtoull(argv[++i], NULL, 10);
+        else if(arg == "--heatmap") showHeatmap = true;
+        else if(arg == "--heat-time" && i+1 < argc) heatmapBudget = atof(argv[++i]);
+        else if(arg == "--db" && i+1 < argc) dbPath = argv[++i];
+        else if(arg == "--record-input" && i+1 < argc) recordInputPath = argv[++i];
+        else if(arg == "--play-input" && i+1 < argc) playInputPath = argv[++i];
+        else if(arg == "--input-speed" && i+1 < argc) {
+            std::string speed = argv[++i];
+            if(speed != "recorded" && speed != "max") { numDims = -1; break; }
+            inputMaxSpeed = speed == "max";
+        }
+        else if(arg == "--headless") headless = true;
+        else if(arg == "--trace" && i+1 < argc) tracePath = argv[++i];
+        else if(numDims < 3) dims[numDims++] = atoi(argv[i]);
+        else { numDims = -1; break; }
+    }
+    if(!playInputPath.empty()) {
+        // the journal decides the board size
+        if(numDims < 0 || !replayPath.empty() || !recordInputPath.empty() || !inputPlayback.load(playInputPath)) numDims = -1;
+        else {
+            dims[0] = inputPlayback.width();
+            dims[1] = inputPlayback.height();
+            dims[2] = inputPlayback.inARow();
+            numDims = 3;
+            playingInput = true;
+        }
+    }
+    if(headless && !playingInput) numDims = -1;
+    if(numDims == 3) {
+        int bw = dims[0], bh = dims[1], k = dims[2];
+        if(!playableBoard(bw, bh, k)) numDims = -1;
+        else board = Board(bw, bh, k);
+    }
+    if(numDims != 0 && numDims != 3) {
+        fprintf(stderr, "Usage: %s [width height k] [--think seconds] [--threads n] [--tree-mb MB]\n"
+                        "          [--continuous] [--hot-reload] [--vsync on|off] [--fps N] [--overlay] [--csv file]\n"
+                        "          [--low-latency] [--record file] [--replay file [--game n]] [--heatmap]\n"
+                        "          [--heat-time seconds] [--db file] [--record-input file]\n"
+                        "          [--play-input file [--input-speed recorded|max] [--headless]] [--trace file]\n", argv[0]);
+        return -1;
+    }
+    if(!tracePath.empty() && !PROFILER_COMPILED_IN)
+        fprintf(stderr, "built without -DPROFILER_ENABLED, %s will have no zones\n", tracePath.c_str());
+    PROFILE_THREAD("main");
+    if(!replayPath.empty()) {
+        // the record decides the board size
+        if(!replayFile.open(replayPath)) return -1;
+        if(replayFile.games() == 0) {
+            fprintf(stderr, "%s has no games\n", replayPath.c_str());
+            return -1;
+        }
+        const RecordBoard& rb = replayFile.recordBoard();
+        if(!playableBoard(rb.width, rb.height, rb.k)) {
+            fprintf(stderr, "%s is for %dx%d k=%d, which cannot be played\n", replayPath.c_str(), rb.width, rb.height, rb.k);
+            return -1;
+        }
+        board = Board(rb.width, rb.height, rb.k);
+        replaying = true;
+    } else if(!recordPath.empty()) {
+        RecordBoard rb;
+        rb.width = board.width();
+        rb.height = board.height();
+        rb.k = board.inARow();
+        if(!recordFile.open(recordPath, rb)) {
+            fprintf(stderr, "cannot record to %s\n", recordPath.c_str());
+            return -1;
+        }
+        recordBlock = GameRecordBlock(rb);
+    }
+    if(!dbPath.empty()) {
+        if(!positionDb.open(dbPath)) return -1;
+        if(positionDb.width() != board.width() || positionDb.height() != board.height() || positionDb.inARow() != board.inARow()) {
+            fprintf(stderr, "%s is for %dx%d k=%d, the board is %dx%d k=%d\n", dbPath.c_str(),
+                    positionDb.width(), positionDb.height(), positionDb.inARow(), board.width(), board.height(), board.inARow());
+            return -1;
+        }
+        heatmapWorker.setDatabase(&positionDb);
+    }
+    if(!recordInputPath.empty() && !inputRecord.open(recordInputPath, board.width(), board.height(), board.inARow())) {
+        fprintf(stderr, "cannot record input to %s\n", recordInputPath.c_str());
+        return -1;
+    }
+
     if(!glfwInit()) {
         fprintf(stderr, "Failed to init GLFW\n");
         return -1;
     }
 
-    // Try to create a compatibility profile window to allow immediate mode drawing
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    // Request a Core Profile context (Modern OpenGL)
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+    if(headless) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
     GLFWwindow* window = glfwCreateWindow(WIN_W, WIN_H, "Three in a Row - Tic Tac Toe", NULL, NULL);
     if(!window) {
         fprintf(stderr, "Failed to create window\n");
@@ -216,43 +648,134 @@ int main() {
         return -1;
     }
     glfwMakeContextCurrent(window);
+
+    glewExperimental = GL_TRUE; // needed for core profiles with older GLEW
+    if(glewInit() != GLEW_OK) {
+        fprintf(stderr, "Failed to initialize GLEW\n");
+        glfwTerminate();
+        return -1;
+    }
+    glfwSwapInterval(vsync ? 1 : 0);
+    if(!renderer.init() || !overlay.init() || !gpuTimer.init()) {
+        fprintf(stderr, "Failed to load board shaders\n");
+        glfwTerminate();
+        return -1;
+    }
+    if(hotReload) shaderCache().watch();
+
+    glfwGetWindowSize(window, &windowW, &windowH);
+    glfwGetFramebufferSize(window, &framebufferW, &framebufferH);
+    glfwGetCursorPos(window, &cursorX, &cursorY);
     glfwSetMouseButtonCallback(window, mouseButtonCallback);
+    glfwSetCursorPosCallback(window, cursorPosCallback);
+    glfwSetWindowSizeCallback(window, windowSizeCallback);
     glfwSetKeyCallback(window, keyCallback);
+    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    glfwSetWindowRefreshCallback(window, windowRefreshCallback);
+    journalStart = glfwGetTime();
+    inputRecord.add(0.0, JOURNAL_WINDOW, windowW, windowH);
+    inputRecord.add(0.0, JOURNAL_FRAMEBUFFER, framebufferW, framebufferH);
 
+    heatmapWorker.start(heatmapBudget);
     resetGame();
+    if(replaying && !loadReplayGame(window, firstReplayGame)) loadReplayGame(window, 0);
 
+    limiter.setTargetFps(targetFps);
+    FrameLog frameLog(!csvPath.empty());
+    long frames = 0;
+    double startTime = glfwGetTime();
+    double lastSwap = startTime;
+    bool drewFrame = false;
     while(!glfwWindowShouldClose(window)) {
-        int w,h;
-        glfwGetFramebufferSize(window, &w, &h);
-        glViewport(0,0,w,h);
-        glClearColor(0.95f, 0.95f, 0.95f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        renderBoard(w,h);
-
-        // optional: draw simple HUD (which player turn) using small squares (no real text)
-        // show small indicator top-left
-        if(!gameOver) {
-            if(currentPlayer == 1) glColor3f(0.9f,0.2f,0.2f); else glColor3f(0.12f,0.2f,0.9f);
-            glBegin(GL_QUADS);
-              glVertex2f(-0.98f,0.92f); glVertex2f(-0.88f,0.92f);
-              glVertex2f(-0.88f,0.82f); glVertex2f(-0.98f,0.82f);
-            glEnd();
-        } else {
-            // draw a small green/red based on winner/draw
-            if(winner == 2) glColor3f(0.4f,0.5f,0.4f); // draw color
-            else if(winner == 1) glColor3f(1.0f,0.7f,0.2f);
-            else glColor3f(0.2f,0.9f,0.7f);
-            glBegin(GL_QUADS);
-              glVertex2f(-0.98f,0.92f); glVertex2f(-0.88f,0.92f);
-              glVertex2f(-0.88f,0.82f); glVertex2f(-0.98f,0.82f);
-            glEnd();
+        if(lowLatency) {
+            // sleep off the frame cap first, then take the newest input
+            if(drewFrame) limiter.wait();
+            glfwPollEvents();
         }
+        drewFrame = false;
+        pollComputerMove();
+        playJournal(window);
+        pollHeatmap();
+        if(hotReload && shaderCache().poll() > 0) markDirty();
+        long gpuFrame;
+        double gpuMs;
+        while(gpuTimer.collect(gpuFrame, gpuMs)) frameLog.setGpuMs(gpuFrame, gpuMs);
+
+        if(needsRedraw || continuousRedraw) {
+            PROFILE_ZONE("frame");
+            needsRedraw = false;
+            double frameStart = glfwGetTime();
+            int w = framebufferW, h = framebufferH;
+            gpuTimer.begin(frames);
+            renderBoard(w,h);
+            FrameRecord rec;
+            rec.frame = frames;
+            rec.drawCalls = renderer.drawCalls();
+            rec.vertices = renderer.vertexCount();
+            if(showOverlay) {
+                drawOverlay(frameLog, w, h);
+                rec.drawCalls += overlay.drawCalls();
+                rec.vertices += overlay.vertexCount();
+            }
+            gpuTimer.end();
+            double submitted = glfwGetTime();
+            rec.cpuMs = (submitted - frameStart) * 1000.0;
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+            {
+                PROFILE_ZONE("glfwSwapBuffers");
+                glfwSwapBuffers(window);
+            }
+            double now = glfwGetTime();
+            if(lowLatency || latency.pending()) {
+                if(latency.frameDone(submitted, now, waitForGpu())) rec.inputMs = latency.latest().totalMs();
+            }
+            rec.time = now - startTime;
+            rec.frameMs = (now - lastSwap) * 1000.0;
+            lastSwap = now;
+            frameLog.add(rec);
+            frames++;
+            drewFrame = true;
+            if(!lowLatency) limiter.wait();
+        }
+
+        double untilInput = journalWait();
+        if(continuousRedraw || untilInput == 0.0) glfwPollEvents();
+        else if(computerThinking() || heatmapPending()) // wake up to collect the results
+            glfwWaitEventsTimeout(untilInput > 0.0 ? std::min(untilInput, THINKING_TICK) : THINKING_TICK);
+        else if(untilInput > 0.0) glfwWaitEventsTimeout(untilInput);
+        else if(hotReload) glfwWaitEventsTimeout(SHADER_POLL_TICK);
+        else glfwWaitEvents(); // sleep until input / resize / expose
     }
+    double elapsed = glfwGetTime() - startTime;
+    printf("%ld frames in %.1fs (%.1f fps average)\n", frames, elapsed, elapsed > 0.0 ? frames / elapsed : 0.0);
+    latency.print(stdout);
+    if(inputRecord.isOpen()) printf("%zu input events journaled to %s\n", inputRecord.events(), recordInputPath.c_str());
+    inputRecord.close();
+    if(playingInput) printf("input journal: %zu of %zu events played in %.2fs\n", inputPlayback.played(),
+                            inputPlayback.events().size(), journalTime());
 
+    if(!csvPath.empty()) {
+        glFinish(); // pick up the last GPU times
+        long gpuFrame;
+        double gpuMs;
+        while(gpuTimer.collect(gpuFrame, gpuMs)) frameLog.setGpuMs(gpuFrame, gpuMs);
+        if(frameLog.writeCsv(csvPath)) printf("frame counters written to %s\n", csvPath.c_str());
+        else fprintf(stderr, "cannot write %s\n", csvPath.c_str());
+    }
+
+    cancelComputerMove();
+    heatmapWorker.stop();
+    if(!tracePath.empty()) {
+        // every other thread has finished
+        if(profiler().writeChromeTrace(tracePath))
+            printf("%llu profiler zones written to %s (%llu dropped)\n", (unsigned long long)profiler().zones(),
+                   tracePath.c_str(), (unsigned long long)profiler().dropped());
+        else fprintf(stderr, "cannot write %s\n", tracePath.c_str());
+    }
+    gpuTimer.destroy();
+    overlay.destroy();
+    renderer.destroy();
+    shaderCache().clear();
     glfwDestroyWindow(window);
     glfwTerminate();
     return 0;
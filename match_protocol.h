@@ -0,0 +1,74 @@
+// match_protocol.h
+// Binary protocol between game_server and its clients (loadgen).
+//
+// Every message is one fixed 8-byte frame, little endian:
+//   byte 0     type (MsgType)
+//   byte 1     value: side, result or error code, depending on the type
+//   bytes 2-3  cell (0..8, row-major like game_state.h)
+//   bytes 4-7  match id
+// so a stream is cut into messages without any length prefix.
+//
+// A match is the classic 3x3 game. The client that creates it plays X,
+// the one that joins it plays O, and X may move once O has joined:
+//   X: CREATE                  -> CREATED(match, side 1)
+//   O: JOIN(match)             -> JOINED(match, side -1);  X gets OPPONENT_JOINED
+//   X: MOVE(match, cell)       -> MOVED(match, cell, result);  O gets OPPONENT_MOVED
+// result is 0 while playing, 1 X wins, -1 O wins, 2 draw; the server forgets
+// a match as soon as it is over. If a player disconnects, the other gets
+// OPPONENT_LEFT. Requests that cannot be served get ERROR(match, MsgError).
+//
+// No GLFW / OpenGL dependency.
+
+#pragma once
+
+#include <cstdint>
+
+const int MSG_SIZE = 8;
+
+enum MsgType : uint8_t {
+    // client -> server
+    MSG_CREATE = 1,
+    MSG_JOIN = 2,
+    MSG_MOVE = 3,
+    // server -> client
+    MSG_CREATED = 16,
+    MSG_JOINED = 17,
+    MSG_OPPONENT_JOINED = 18,
+    MSG_MOVED = 19,
+    MSG_OPPONENT_MOVED = 20,
+    MSG_OPPONENT_LEFT = 21,
+    MSG_ERROR = 22
+};
+
+enum MsgError : int8_t {
+    ERR_BAD_MESSAGE = 1,
+    ERR_NO_MATCH = 2,    // unknown or finished match
+    ERR_MATCH_FULL = 3,
+    ERR_NOT_STARTED = 4, // nobody has joined yet
+    ERR_NOT_YOUR_TURN = 5,
+    ERR_ILLEGAL_MOVE = 6
+};
+
+struct Msg {
+    uint8_t type = 0;
+    int8_t value = 0;
+    uint16_t cell = 0;
+    uint32_t match = 0;
+};
+
+inline void encodeMsg(const Msg& m, unsigned char* out) {
+    out[0] = m.type;
+    out[1] = (unsigned char)m.value;
+    out[2] = (unsigned char)(m.cell & 0xFF);
+    out[3] = (unsigned char)(m.cell >> 8);
+    for(int i=0;i<4;i++) out[4 + i] = (unsigned char)(m.match >> (8 * i));
+}
+
+inline Msg decodeMsg(const unsigned char* in) {
+    Msg m;
+    m.type = in[0];
+    m.value = (int8_t)in[1];
+    m.cell = (uint16_t)(in[2] | in[3] << 8);
+    for(int i=0;i<4;i++) m.match |= (uint32_t)in[4 + i] << (8 * i);
+    return m;
+}
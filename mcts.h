@@ -0,0 +1,288 @@
+// mcts.h
+// Multithreaded Monte Carlo Tree Search player for Board (any width/height/k).
+//
+// Root parallelism: every worker thread grows its own UCT tree from the same
+// position with its own Rng, so the hot loop shares nothing and needs no
+// locks. The only shared values are atomics (stop flag, playout counter);
+// the root statistics of all trees are summed once the time budget is up.
+//
+// The search is meant to be run off the render thread, e.g. with std::async,
+// and can be cancelled early through MctsConfig::cancel.
+//
+// Tree nodes live in per-thread NodePools (node_pool.h): 16-byte nodes, four
+// to a cache line, children contiguous and addressed by 32-bit index, and
+// no parent links (a playout backs up along the path it took). An
+// MctsSearcher keeps its pools from one move to the next, so only its first
+// search allocates; MctsConfig::treeBytes bounds how big the trees get.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "board.h"
+#include "node_pool.h"
+#include "profiler.h"
+#include "rng.h"
+
+const int MCTS_MAX_CELLS = 32767; // nodes store cells as int16_t
+
+struct MctsConfig {
+    double timeBudget = 1.0;      // seconds of thinking per move
+    int threads = 0;              // 0 => one per hardware thread
+    float exploration = 1.4f;     // UCT exploration constant
+    int neighbourhood = 2;        // only expand cells this close to a stone (0 = all)
+    uint64_t seed = 1;
+    size_t treeBytes = 256u << 20; // node memory, split over the threads; a full tree stops growing
+    const std::atomic<bool>* cancel = nullptr; // set to stop early
+};
+
+struct MctsResult {
+    int move = -1;
+    uint64_t playouts = 0;
+    double seconds = 0.0;
+    int threads = 0;
+    std::vector<uint32_t> visits; // per cell, summed over all trees
+    std::vector<float> winRate;   // per cell for the side to move, -1 if not searched
+    uint64_t nodes = 0;           // tree nodes, summed over all trees
+    size_t treeBytes = 0;         // memory those nodes take
+    size_t poolBytes = 0;         // memory reserved for them
+    bool treeFull = false;        // some tree ran out of room and stopped growing
+
+    double playoutsPerSecond() const { return seconds > 0.0 ? playouts / seconds : 0.0; }
+};
+
+namespace mcts_detail {
+
+struct Node {
+    uint32_t firstChild; // children are stored contiguously
+    uint32_t visits;
+    uint32_t wins;       // half-points for the player who played `move`: win 2, draw 1
+    int16_t move;        // cell played to reach this node
+    int16_t numChildren; // -1 until expanded
+};
+static_assert(sizeof(Node) == 16, "four nodes per cache line");
+
+// empty cells worth considering: near existing stones on big boards
+inline void candidateMoves(const Board& b, int radius, std::vector<int>& out) {
+    out.clear();
+    if(radius <= 0 || b.moveCount() == 0) {
+        if(b.moveCount() == 0 && radius > 0) {
+            out.push_back((b.height() / 2) * b.width() + b.width() / 2);
+            return;
+        }
+        for(int i=0;i<b.size();i++) if(b.isEmpty(i)) out.push_back(i);
+        return;
+    }
+    for(int i=0;i<b.size();i++){
+        if(!b.isEmpty(i)) continue;
+        int r = i / b.width(), c = i % b.width();
+        bool near = false;
+        for(int dr=-radius;dr<=radius && !near;dr++){
+            for(int dc=-radius;dc<=radius;dc++){
+                int rr = r + dr, cc = c + dc;
+                if(rr < 0 || rr >= b.height() || cc < 0 || cc >= b.width()) continue;
+                if(b.at(rr, cc) != 0) { near = true; break; }
+            }
+        }
+        if(near) out.push_back(i);
+    }
+}
+
+class Worker {
+public:
+    // grows its tree in `nodes`, which it resets; node 0 is the root
+    Worker(const Board& root, const MctsConfig& cfg, uint64_t seed, NodePool<Node>& nodes)
+        : root(root), cfg(cfg), rng(seed), board(root), nodes(nodes), path(root.size() + 2) {
+        nodes.reset();
+        nodes[nodes.allocate(1)] = {POOL_NONE, 0, 0, -1, -1};
+    }
+
+    // one selection / expansion / playout / backpropagation step
+    void iterate() {
+        board = root;
+        uint32_t n = 0;
+        int len = 0;
+        path[len++] = n;
+        while(nodes[n].numChildren > 0) {
+            n = select(n);
+            path[len++] = n;
+            board.play(nodes[n].move, board.sideToMove());
+        }
+        if(board.result() == 0 && nodes[n].numChildren < 0) {
+            expand(n);
+            if(nodes[n].numChildren > 0) {
+                n = nodes[n].firstChild + rng.below((uint32_t)nodes[n].numChildren);
+                path[len++] = n;
+                board.play(nodes[n].move, board.sideToMove());
+            }
+        }
+        int result = playout();
+        backpropagate(len, result);
+    }
+
+    bool full() const { return treeFull; }
+
+private:
+    const Board& root;
+    const MctsConfig& cfg;
+    Rng rng;
+    Board board; // scratch copy, reused every iteration
+    NodePool<Node>& nodes;
+    std::vector<uint32_t> path; // root .. leaf of the current iteration
+    std::vector<int> scratch;
+    bool treeFull = false;
+
+    uint32_t select(uint32_t n) {
+        const Node& p = nodes[n];
+        float logN = logf((float)p.visits + 1.0f);
+        uint32_t best = p.firstChild;
+        float bestScore = -1.0f;
+        for(int i=0;i<p.numChildren;i++){
+            const Node& c = nodes[p.firstChild + i];
+            if(c.visits == 0) return p.firstChild + i;
+            float score = c.wins * 0.5f / c.visits + cfg.exploration * sqrtf(logN / c.visits);
+            if(score > bestScore) { bestScore = score; best = p.firstChild + i; }
+        }
+        return best;
+    }
+
+    // leaves n unexpanded when the pool is full: the tree stops growing
+    // there and later iterations just play out from it
+    void expand(uint32_t n) {
+        candidateMoves(board, cfg.neighbourhood, scratch);
+        uint32_t first = nodes.allocate((uint32_t)scratch.size());
+        if(first == POOL_NONE) {
+            treeFull = true;
+            return;
+        }
+        for(size_t i=0;i<scratch.size();i++) nodes[first + (uint32_t)i] = {POOL_NONE, 0, 0, (int16_t)scratch[i], -1};
+        nodes[n].firstChild = first;
+        nodes[n].numChildren = (int16_t)scratch.size();
+    }
+
+    // random moves until the game ends; returns Board::result()
+    int playout() {
+        if(board.result() != 0) return board.result();
+        scratch.clear();
+        for(int i=0;i<board.size();i++) if(board.isEmpty(i)) scratch.push_back(i);
+        int remaining = (int)scratch.size();
+        while(board.result() == 0) {
+            int pick = (int)rng.below((uint32_t)remaining);
+            int cell = scratch[pick];
+            scratch[pick] = scratch[--remaining];
+            board.play(cell, board.sideToMove());
+        }
+        return board.result();
+    }
+
+    void backpropagate(int len, int result) {
+        // the player who moved into the root is the opponent of root's side to move
+        int mover = -root.sideToMove();
+        // the node at depth d was reached by a move of player mover * (-1)^d
+        for(int d=0;d<len;d++){
+            Node& node = nodes[path[d]];
+            int player = (d & 1) ? -mover : mover;
+            node.visits++;
+            if(result == player) node.wins += 2;
+            else if(result == 2) node.wins += 1;
+        }
+    }
+};
+
+} // namespace mcts_detail
+
+// Runs searches with one node pool per thread that is kept between them,
+// so repeated searches (a game, the heatmap's rounds) reuse the same memory.
+// One search at a time per MctsSearcher.
+class MctsSearcher {
+public:
+    // Search `root` for the side to move and return the most visited move.
+    MctsResult search(const Board& root, const MctsConfig& cfg) {
+        PROFILE_ZONE("MctsSearcher::search");
+        using namespace mcts_detail;
+        using clock = std::chrono::steady_clock;
+
+        MctsResult res;
+        res.threads = cfg.threads > 0 ? cfg.threads : (int)std::thread::hardware_concurrency();
+        if(res.threads < 1) res.threads = 1;
+        res.visits.assign(root.size(), 0);
+        res.winRate.assign(root.size(), -1.0f);
+        if(root.result() != 0) return res;
+
+        // room for at least a root and its children in every tree
+        size_t perThread = cfg.treeBytes / res.threads / sizeof(Node);
+        if(perThread < (size_t)root.size() + 1) perThread = root.size() + 1;
+        if(pools.size() < (size_t)res.threads) pools.resize(res.threads);
+        for(int t=0;t<res.threads;t++) pools[t].reserve(perThread);
+
+        std::atomic<bool> stop(false);
+        std::atomic<uint64_t> playouts(0);
+        std::atomic<bool> full(false);
+        std::vector<double> wins(root.size(), 0.0); // half-points
+
+        auto start = clock::now();
+        auto deadline = start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(cfg.timeBudget));
+
+        auto work = [&](int t) {
+            if(t > 0) PROFILE_THREAD("mcts worker");
+            PROFILE_ZONE("mcts playouts");
+            Worker worker(root, cfg, cfg.seed * 0x100000001B3ull + t, pools[t]);
+            uint64_t local = 0;
+            while(!stop.load(std::memory_order_relaxed)) {
+                // batch the clock checks, they cost more than a 3x3 playout
+                for(int i=0;i<64;i++) worker.iterate();
+                local += 64;
+                if(clock::now() >= deadline || (cfg.cancel && cfg.cancel->load(std::memory_order_relaxed)))
+                    stop.store(true, std::memory_order_relaxed);
+            }
+            playouts.fetch_add(local, std::memory_order_relaxed);
+            if(worker.full()) full.store(true, std::memory_order_relaxed);
+        };
+
+        std::vector<std::thread> threads;
+        for(int t=1;t<res.threads;t++) threads.emplace_back(work, t);
+        work(0);
+        for(auto& th : threads) th.join();
+
+        // merge the root children of every tree, straight from the pools
+        for(int t=0;t<res.threads;t++){
+            const NodePool<Node>& tree = pools[t];
+            const Node& r = tree[0];
+            for(int i=0;i<r.numChildren;i++){
+                const Node& c = tree[r.firstChild + i];
+                res.visits[c.move] += c.visits;
+                wins[c.move] += c.wins;
+            }
+            res.nodes += tree.size();
+            res.treeBytes += tree.bytesUsed();
+            res.poolBytes += tree.bytesReserved();
+        }
+        res.treeFull = full.load();
+        uint32_t bestVisits = 0;
+        for(int i=0;i<root.size();i++){
+            if(res.visits[i] == 0) continue;
+            res.winRate[i] = (float)(wins[i] * 0.5 / res.visits[i]);
+            if(res.visits[i] > bestVisits) { bestVisits = res.visits[i]; res.move = i; }
+        }
+        // no time to visit anything: fall back to the first legal cell
+        for(int i=0;i<root.size() && res.move < 0;i++) if(root.isEmpty(i)) res.move = i;
+
+        res.playouts = playouts.load();
+        res.seconds = std::chrono::duration<double>(clock::now() - start).count();
+        return res;
+    }
+
+private:
+    std::vector<NodePool<mcts_detail::Node>> pools;
+};
+
+// One-off search with pools of its own.
+inline MctsResult mctsSearch(const Board& root, const MctsConfig& cfg) {
+    MctsSearcher searcher;
+    return searcher.search(root, cfg);
+}
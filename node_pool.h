@@ -0,0 +1,103 @@
+// node_pool.h
+// Bump allocator for game-tree search nodes.
+//
+// A search allocates nodes by the million and frees them all at once when
+// the move is made, so there is nothing to gain from freeing them one at a
+// time. NodePool reserves one cache-line-aligned block for a fixed number of
+// nodes up front and hands out contiguous runs of it (a node's children are
+// one run) as 32-bit indices, which are half the size of pointers and stay
+// valid because the block never moves. reset() forgets every node in O(1),
+// so a pool kept across moves costs no allocator calls at all after the
+// first search. When the block is full allocate() fails and the search has
+// to make do with the tree it has; memory use is bounded by the capacity.
+//
+// The block comes from operator new, which for sizes like these maps fresh
+// pages; the kernel only backs the ones that get touched, so reserving a
+// generous capacity is cheap until the tree actually grows into it.
+//
+// No GLFW / OpenGL dependency.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+const uint32_t POOL_NONE = 0xFFFFFFFFu; // allocate() failed / no node
+const size_t POOL_ALIGN = 64;           // cache line
+
+template <class T>
+class NodePool {
+    static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                  "NodePool never runs constructors or destructors");
+
+public:
+    NodePool() = default;
+    explicit NodePool(size_t capacity) { reserve(capacity); }
+    ~NodePool() { release(); }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+    NodePool(NodePool&& o) noexcept { swap(o); }
+    NodePool& operator=(NodePool&& o) noexcept { swap(o); return *this; }
+
+    // (re)allocate room for `capacity` nodes; drops every node. A no-op when
+    // the capacity is already right, so it can be called before every search.
+    void reserve(size_t capacity) {
+        if(capacity > POOL_NONE) capacity = POOL_NONE;
+        if(capacity == cap) { reset(); return; }
+        release();
+        if(capacity == 0) return;
+        nodes = (T*)::operator new(capacity * sizeof(T), std::align_val_t(POOL_ALIGN));
+        cap = (uint32_t)capacity;
+    }
+
+    // forget every node, keep the memory
+    void reset() { used = 0; }
+
+    // `count` contiguous, uninitialised nodes; returns the index of the first
+    // or POOL_NONE if they do not fit
+    uint32_t allocate(uint32_t count) {
+        if(count > cap - used) {
+            failed++;
+            return POOL_NONE;
+        }
+        uint32_t first = used;
+        used += count;
+        if(used > peak) peak = used;
+        return first;
+    }
+
+    T& operator[](uint32_t i) { return nodes[i]; }
+    const T& operator[](uint32_t i) const { return nodes[i]; }
+
+    uint32_t size() const { return used; }
+    uint32_t capacity() const { return cap; }
+    bool full() const { return used == cap; }
+
+    size_t bytesUsed() const { return (size_t)used * sizeof(T); }
+    size_t bytesReserved() const { return (size_t)cap * sizeof(T); }
+    size_t peakBytes() const { return (size_t)peak * sizeof(T); } // most ever used, across resets
+    uint64_t failedAllocations() const { return failed; }         // since construction
+
+private:
+    T* nodes = nullptr;
+    uint32_t cap = 0, used = 0, peak = 0;
+    uint64_t failed = 0;
+
+    void release() {
+        if(nodes) ::operator delete(nodes, std::align_val_t(POOL_ALIGN));
+        nodes = nullptr;
+        cap = used = peak = 0;
+    }
+
+    void swap(NodePool& o) {
+        std::swap(nodes, o.nodes);
+        std::swap(cap, o.cap);
+        std::swap(used, o.used);
+        std::swap(peak, o.peak);
+        std::swap(failed, o.failed);
+    }
+};
@@ -0,0 +1,221 @@
+// offscreen.h
+// Windowless OpenGL 3.3 core context, for benchmarks and image dumps on
+// machines without a display or a GPU (e.g. CI boxes with Mesa llvmpipe).
+//
+// The context comes from EGL on a surfaceless Mesa display (falling back to
+// the default EGL display) and never gets a window surface: everything is
+// drawn into a framebuffer object with an RGBA8 color renderbuffer, which
+// stays bound after init(). The GL loader (GLAD or GLEW) is initialized
+// from eglGetProcAddress once the context is current. AsyncReadback reads
+// frames back through pixel buffer objects without stalling.
+//
+// Linux / EGL only. Include this after the OpenGL loader; link with -lEGL.
+
+#pragma once
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+class OffscreenContext {
+public:
+    bool init(int fbWidth, int fbHeight) {
+        display = openDisplay();
+        EGLint major, minor;
+        if(display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+            fprintf(stderr, "EGL: no display available\n");
+            return false;
+        }
+        if(!eglBindAPI(EGL_OPENGL_API)) {
+            fprintf(stderr, "EGL: desktop OpenGL not supported\n");
+            return false;
+        }
+
+        // surfaceless displays may have no configs at all; EGL_NO_CONFIG is
+        // fine as long as we never create a surface
+        EGLConfig config = nullptr;
+        const EGLint configAttribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+        EGLint numConfigs = 0;
+        eglChooseConfig(display, configAttribs, &config, 1, &numConfigs);
+        if(numConfigs < 1) config = nullptr;
+
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+        if(context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+            fprintf(stderr, "EGL: failed to create an OpenGL 3.3 core context (0x%x)\n", eglGetError());
+            return false;
+        }
+
+#if defined(__glad_h_)
+        if(!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+            fprintf(stderr, "Failed to initialize GLAD\n");
+            return false;
+        }
+#elif defined(__glew_h__)
+        glewExperimental = GL_TRUE;
+        glewInit(); // may report GLEW_ERROR_NO_GLX_DISPLAY; the entry points still load
+#endif
+
+        glGenFramebuffers(1, &fbo);
+        glGenRenderbuffers(1, &colorRB);
+        return resize(fbWidth, fbHeight);
+    }
+
+    void destroy() {
+        if(display == EGL_NO_DISPLAY) return;
+        if(context != EGL_NO_CONTEXT) {
+            glDeleteRenderbuffers(1, &colorRB);
+            glDeleteFramebuffers(1, &fbo);
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+        }
+        eglTerminate(display);
+        display = EGL_NO_DISPLAY;
+        context = EGL_NO_CONTEXT;
+    }
+
+    // (re)allocate the color buffer; leaves the FBO bound and the viewport set
+    bool resize(int fbWidth, int fbHeight) {
+        w = fbWidth;
+        h = fbHeight;
+        glBindRenderbuffer(GL_RENDERBUFFER, colorRB);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRB);
+        if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            fprintf(stderr, "Offscreen framebuffer incomplete\n");
+            return false;
+        }
+        glViewport(0, 0, w, h);
+        return true;
+    }
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    // RGBA8 pixels, bottom row first (OpenGL order)
+    void readPixels(std::vector<unsigned char>& out) const {
+        out.resize((size_t)w * h * 4);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, out.data());
+    }
+
+    // e.g. "llvmpipe (LLVM 15.0.7, 256 bits)"
+    const char* rendererName() const { return (const char*)glGetString(GL_RENDERER); }
+
+private:
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    GLuint fbo = 0, colorRB = 0;
+    int w = 0, h = 0;
+
+    // Mesa's surfaceless platform needs neither X11 nor a DRM device
+    static EGLDisplay openDisplay() {
+        const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if(extensions && strstr(extensions, "EGL_MESA_platform_surfaceless")) {
+            auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+            if(getPlatformDisplay) {
+                EGLDisplay d = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                if(d != EGL_NO_DISPLAY) return d;
+            }
+        }
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+};
+
+// Asynchronous readback through a ring of pixel buffer objects. read() only
+// queues the copy of the current framebuffer into a PBO (plus a fence), so
+// the CPU can go on submitting the next frames; collect() maps the oldest
+// copy once its fence has signalled. With a ring of N buffers the pixels of
+// frame i are picked up while frame i+N-1 is being drawn, instead of
+// stalling in glReadPixels after every frame.
+class AsyncReadback {
+public:
+    explicit AsyncReadback(int depth = 3) : slots(depth < 1 ? 1 : depth) {}
+
+    void destroy() {
+        for(Slot& s : slots) {
+            if(s.fence) glDeleteSync(s.fence);
+            if(s.pbo) glDeleteBuffers(1, &s.pbo);
+            s = Slot();
+        }
+        head = count = 0;
+    }
+
+    bool full() const { return count == slots.size(); }
+    size_t pending() const { return count; }
+
+    // queue a copy of the bound framebuffer (RGBA8); `tag` comes back from
+    // collect(). Returns false if the ring is full: collect() first.
+    bool read(int width, int height, int tag) {
+        if(full()) return false;
+        Slot& s = slots[(head + count) % slots.size()];
+        size_t bytes = (size_t)width * height * 4;
+        if(!s.pbo) glGenBuffers(1, &s.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+        if(bytes > s.capacity) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+            s.capacity = bytes;
+        }
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        s.width = width;
+        s.height = height;
+        s.tag = tag;
+        count++;
+        return true;
+    }
+
+    // pixels of the oldest queued copy, bottom row first; `tag` is always set.
+    // With wait == false this returns false instead of blocking if the copy
+    // is not done yet (and keeps it queued).
+    bool collect(std::vector<unsigned char>& out, int& width, int& height, int& tag, bool wait = true) {
+        if(count == 0) return false;
+        Slot& s = slots[head];
+        width = s.width;
+        height = s.height;
+        tag = s.tag;
+        GLuint64 timeout = wait ? 10000000000ull : 0; // 10 s
+        GLenum status = glClientWaitSync(s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        if(status == GL_TIMEOUT_EXPIRED && !wait) return false;
+        glDeleteSync(s.fence);
+        s.fence = nullptr;
+
+        // a copy that timed out or failed is dropped, so the ring never wedges
+        const void* mapped = nullptr;
+        if(status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            size_t bytes = (size_t)s.width * s.height * 4;
+            out.resize(bytes);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+            mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+            if(mapped) {
+                memcpy(out.data(), mapped, bytes);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+
+        head = (head + 1) % slots.size();
+        count--;
+        return mapped != nullptr;
+    }
+
+private:
+    struct Slot {
+        GLuint pbo = 0;
+        size_t capacity = 0;
+        GLsync fence = nullptr;
+        int width = 0, height = 0, tag = 0;
+    };
+    std::vector<Slot> slots;
+    size_t head = 0, count = 0;
+};
@@ -0,0 +1,83 @@
+// outcome_table.h
+// Complete outcome table for Three-in-a-Row, generated at compile time.
+//
+// One entry per base-3 encoding (GameState::index()): the game-theoretic
+// score for the side to move and the best cell to play. The table is built
+// by a constexpr retrograde pass and stored in the executable's read-only
+// data (~39 KB), so AI moves and hints are a single array lookup with no
+// search and no startup cost.
+//
+// Scores use the same convention as solver.h: a win that ends the game at
+// ply n is worth 10 - n for the winner, a draw is 0. Ties between moves are
+// broken by MOVE_ORDER, so the table plays exactly like Solver::bestMove().
+
+#pragma once
+
+#include <cstdint>
+
+#include "game_state.h"
+
+struct OutcomeEntry {
+    int8_t score; // for the side to move
+    int8_t move;  // best cell, -1 for finished or unreachable positions
+};
+
+struct OutcomeTable {
+    OutcomeEntry entry[NUM_POSITIONS];
+};
+
+constexpr OutcomeTable makeOutcomeTable() {
+    OutcomeTable t{};
+    int pow3[9] = {};
+    pow3[0] = 1;
+    for(int i=1;i<9;i++) pow3[i] = pow3[i-1] * 3;
+
+    // a child always has one more stone, i.e. a larger encoding, so walking
+    // the encodings downwards visits every child before its parents
+    for(int idx=NUM_POSITIONS-1;idx>=0;idx--){
+        OutcomeEntry& e = t.entry[idx];
+        e.score = 0;
+        e.move = -1;
+
+        uint16_t x = 0, o = 0;
+        int rest = idx;
+        for(int i=0;i<9;i++){
+            int digit = rest % 3;
+            rest /= 3;
+            if(digit == 1) x |= (uint16_t)(1u << i);
+            else if(digit == 2) o |= (uint16_t)(1u << i);
+        }
+
+        int nx = __builtin_popcount(x), no = __builtin_popcount(o);
+        if(nx != no && nx != no + 1) continue; // unreachable
+        int n = nx + no;
+        if(WIN_LINE_TABLE.line[x] >= 0 || WIN_LINE_TABLE.line[o] >= 0) {
+            e.score = (int8_t)-(10 - n); // the previous player won
+            continue;
+        }
+        if(n == 9) continue; // draw
+
+        int digit = (nx == no) ? 1 : 2; // X to move : O to move
+        int best = -100;
+        for(int i : MOVE_ORDER) {
+            if((x | o) >> i & 1) continue;
+            int score = -t.entry[idx + digit * pow3[i]].score;
+            if(score > best) { best = score; e.move = (int8_t)i; }
+        }
+        e.score = (int8_t)best;
+    }
+    return t;
+}
+
+inline constexpr OutcomeTable OUTCOME_TABLE = makeOutcomeTable();
+
+static_assert(OUTCOME_TABLE.entry[0].score == 0, "perfect play from the empty board is a draw");
+
+inline const OutcomeEntry& lookupOutcome(const GameState& s) {
+    return OUTCOME_TABLE.entry[s.index()];
+}
+
+// best cell for the side to move, -1 if the game is over
+inline int bestMoveFromTable(const GameState& s) {
+    return lookupOutcome(s).move;
+}
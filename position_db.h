@@ -0,0 +1,334 @@
+// position_db.h
+// Exact win / draw / loss tables for small m,n,k boards (4x4, 5x5, ...),
+// written by position_db_gen and memory mapped by main.cpp (--db).
+//
+// Positions are numbered by a perfect hash, grouped by the number of
+// stones n: X has ceil(n/2) of them and O floor(n/2), so a layer holds
+// C(cells, n) * C(n, ceil(n/2)) positions, each exactly once:
+//   index = rank(occupied cells) * C(n, xs) + rank(which of them are X)
+// where rank() is the combinatorial (colex) rank of a set, sum of
+// C(element, i) over its elements in increasing order. Ranking and
+// unranking are O(cells) with a small binomial table, and no position
+// with impossible stone counts takes any space.
+//
+// Every position is 2 bits (DbValue, for the side to move), 4 per byte.
+// The file (little endian):
+//   4096-byte header: "TTDB", u16 version, width, height, k, first layer,
+//                     cells, then per layer n = 0..cells: u64 offset, u64 positions
+//                     (0 / 0 for layers that were not generated)
+//   one page-aligned 2-bit array per generated layer
+// The generator writes the magic last, so an interrupted run leaves a file
+// the reader rejects. A table may hold only the layers from some stone
+// count on (an endgame table), since solving a layer only needs the next.
+//
+// The reader maps the file read-only with MADV_RANDOM: a lookup is one
+// rank computation and one byte read, and only the pages that lookups
+// touch are ever read from disk.
+//
+// POSIX (mmap). No GLFW / OpenGL dependency.
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+enum DbValue : uint8_t {
+    DB_UNKNOWN = 0, // unreachable, or a layer the table does not have
+    DB_WIN = 1,     // for the side to move
+    DB_DRAW = 2,
+    DB_LOSS = 3
+};
+
+const int DB_MAX_CELLS = 32; // stones are uint32 masks
+const size_t DB_HEADER_BYTES = 4096;
+const size_t DB_PAGE = 4096;
+const uint16_t DB_VERSION = 1;
+
+inline void storeLE64(unsigned char* p, uint64_t v, int bytes) {
+    for(int i=0;i<bytes;i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+inline uint64_t loadLE64(const unsigned char* p, int bytes) {
+    uint64_t v = 0;
+    for(int i=0;i<bytes;i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+// board geometry, line masks and the position numbering
+class PositionIndexer {
+public:
+    PositionIndexer(int width = 3, int height = 3, int k = 3) : w(width), h(height), k(k), n(width * height) {
+        for(int i=0;i<=DB_MAX_CELLS;i++){
+            binom[i][0] = 1;
+            for(int j=1;j<=DB_MAX_CELLS;j++) binom[i][j] = i == 0 ? 0 : binom[i-1][j-1] + binom[i-1][j];
+        }
+        if(!valid()) return;
+        // every k-cell window in the four directions
+        static const int DIRS[4][2] = {{0,1},{1,0},{1,1},{1,-1}};
+        linesThrough.assign(n, {});
+        for(int r=0;r<h;r++){
+            for(int c=0;c<w;c++){
+                for(const auto& d : DIRS) {
+                    int er = r + d[0] * (k - 1), ec = c + d[1] * (k - 1);
+                    if(er < 0 || er >= h || ec < 0 || ec >= w) continue;
+                    uint32_t m = 0;
+                    for(int i=0;i<k;i++) m |= 1u << ((r + d[0] * i) * w + c + d[1] * i);
+                    lines.push_back(m);
+                    for(int i=0;i<k;i++) linesThrough[(r + d[0] * i) * w + c + d[1] * i].push_back(m);
+                }
+            }
+        }
+    }
+
+    bool valid() const { return w >= 1 && h >= 1 && k >= 1 && n <= DB_MAX_CELLS; }
+    int width() const { return w; }
+    int height() const { return h; }
+    int inARow() const { return k; }
+    int cells() const { return n; }
+    uint64_t choose(int a, int b) const { return b < 0 || b > a ? 0 : binom[a][b]; }
+
+    static int xStones(int stones) { return (stones + 1) / 2; }
+    // positions with `stones` stones
+    uint64_t layerSize(int stones) const { return choose(n, stones) * choose(stones, xStones(stones)); }
+
+    bool hasLine(uint32_t m) const {
+        for(uint32_t l : lines) if((m & l) == l) return true;
+        return false;
+    }
+    // a line through `cell` (the stone just placed)
+    bool hasLineThrough(uint32_t m, int cell) const {
+        for(uint32_t l : linesThrough[cell]) if((m & l) == l) return true;
+        return false;
+    }
+
+    // index of the position within its layer (popcount(x | o) stones)
+    uint64_t rank(uint32_t x, uint32_t o) const {
+        uint32_t occ = x | o;
+        int stones = __builtin_popcount(occ);
+        uint64_t occRank = 0, xRank = 0;
+        int i = 0, xi = 0;
+        for(uint32_t m=occ;m;m&=m-1){
+            int c = __builtin_ctz(m);
+            occRank += binom[c][i + 1];
+            if(x >> c & 1) { xRank += binom[i][xi + 1]; xi++; }
+            i++;
+        }
+        return occRank * choose(stones, xStones(stones)) + xRank;
+    }
+
+    void unrank(int stones, uint64_t index, uint32_t& x, uint32_t& o) const {
+        int xs = xStones(stones);
+        uint64_t per = choose(stones, xs);
+        uint32_t occ = unrankSet(index / per, stones, n);
+        uint32_t xSlots = unrankSet(index % per, xs, stones);
+        x = o = 0;
+        int slot = 0;
+        for(uint32_t m=occ;m;m&=m-1,slot++){
+            uint32_t bit = m & (0u - m);
+            if(xSlots >> slot & 1) x |= bit;
+            else o |= bit;
+        }
+    }
+
+private:
+    int w, h, k, n;
+    uint64_t binom[DB_MAX_CELLS + 1][DB_MAX_CELLS + 1];
+    std::vector<uint32_t> lines;
+    std::vector<std::vector<uint32_t>> linesThrough;
+
+    // the `size`-element subset of 0..universe-1 with colex rank r
+    uint32_t unrankSet(uint64_t r, int size, int universe) const {
+        uint32_t s = 0;
+        int c = universe - 1;
+        for(int i=size;i>=1;i--){
+            while(binom[c][i] > r) c--;
+            s |= 1u << c;
+            r -= binom[c][i];
+            c--;
+        }
+        return s;
+    }
+};
+
+// 2-bit value arrays
+inline DbValue getDbValue(const unsigned char* layer, uint64_t index) {
+    return (DbValue)(layer[index >> 2] >> ((index & 3) * 2) & 3);
+}
+
+inline void setDbValue(unsigned char* layer, uint64_t index, DbValue v) {
+    unsigned char& b = layer[index >> 2];
+    int shift = (int)(index & 3) * 2;
+    b = (unsigned char)((b & ~(3 << shift)) | v << shift);
+}
+
+inline uint64_t dbLayerBytes(uint64_t positions) { return (positions + 3) / 4; }
+
+// header layout shared by the generator and the reader
+struct DbHeader {
+    int width = 0, height = 0, k = 0, firstLayer = 0, cells = 0;
+    uint64_t offset[DB_MAX_CELLS + 1] = {};
+    uint64_t positions[DB_MAX_CELLS + 1] = {};
+
+    // everything except the magic, which the generator writes last
+    void encode(unsigned char* p) const {
+        memset(p, 0, DB_HEADER_BYTES);
+        storeLE64(p + 4, DB_VERSION, 2);
+        storeLE64(p + 6, (uint64_t)width, 2);
+        storeLE64(p + 8, (uint64_t)height, 2);
+        storeLE64(p + 10, (uint64_t)k, 2);
+        storeLE64(p + 12, (uint64_t)firstLayer, 2);
+        storeLE64(p + 14, (uint64_t)cells, 2);
+        for(int s=0;s<=cells;s++){
+            storeLE64(p + 16 + 16 * s, offset[s], 8);
+            storeLE64(p + 24 + 16 * s, positions[s], 8);
+        }
+    }
+
+    bool decode(const unsigned char* p) {
+        if(memcmp(p, "TTDB", 4) != 0 || loadLE64(p + 4, 2) != DB_VERSION) return false;
+        width = (int)loadLE64(p + 6, 2);
+        height = (int)loadLE64(p + 8, 2);
+        k = (int)loadLE64(p + 10, 2);
+        firstLayer = (int)loadLE64(p + 12, 2);
+        cells = (int)loadLE64(p + 14, 2);
+        if(cells != width * height || cells > DB_MAX_CELLS || firstLayer > cells) return false;
+        for(int s=0;s<=cells;s++){
+            offset[s] = loadLE64(p + 16 + 16 * s, 8);
+            positions[s] = loadLE64(p + 24 + 16 * s, 8);
+        }
+        return true;
+    }
+};
+
+inline void writeDbMagic(unsigned char* p) { memcpy(p, "TTDB", 4); }
+
+// Read-only view of a table file.
+class PositionDb {
+public:
+    PositionDb() = default;
+    PositionDb(const PositionDb&) = delete;
+    PositionDb& operator=(const PositionDb&) = delete;
+    ~PositionDb() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if(fd < 0) { perror(path.c_str()); return false; }
+        struct stat st;
+        if(fstat(fd, &st) != 0 || (size_t)st.st_size < DB_HEADER_BYTES) {
+            fprintf(stderr, "%s: not a position table\n", path.c_str());
+            ::close(fd);
+            return false;
+        }
+        size = (size_t)st.st_size;
+        void* m = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(m == MAP_FAILED) { perror("mmap"); size = 0; return false; }
+        data = (const unsigned char*)m;
+        madvise(m, size, MADV_RANDOM); // lookups jump around, don't read ahead
+
+        bool ok = header.decode(data);
+        for(int s=header.firstLayer;ok && s<=header.cells;s++){
+            ok = header.positions[s] == 0
+              || header.offset[s] + dbLayerBytes(header.positions[s]) <= size;
+        }
+        if(!ok) {
+            fprintf(stderr, "%s: not a complete position table\n", path.c_str());
+            close();
+            return false;
+        }
+        indexer = PositionIndexer(header.width, header.height, header.k);
+        return true;
+    }
+
+    void close() {
+        if(data) munmap((void*)data, size);
+        data = nullptr;
+        size = 0;
+    }
+
+    bool isOpen() const { return data != nullptr; }
+    int width() const { return header.width; }
+    int height() const { return header.height; }
+    int inARow() const { return header.k; }
+    int firstLayer() const { return header.firstLayer; }
+    const PositionIndexer& positions() const { return indexer; }
+
+    // the table is for this board size and has the position's layer
+    bool covers(const Board& b) const {
+        return data && b.width() == header.width && b.height() == header.height && b.inARow() == header.k
+            && b.moveCount() >= header.firstLayer;
+    }
+
+    DbValue value(uint32_t x, uint32_t o) const {
+        int stones = __builtin_popcount(x | o);
+        if(!data || stones < header.firstLayer || stones > header.cells || header.positions[stones] == 0) return DB_UNKNOWN;
+        return getDbValue(data + header.offset[stones], indexer.rank(x, o));
+    }
+
+    static void masks(const Board& b, uint32_t& x, uint32_t& o) {
+        x = o = 0;
+        for(int i=0;i<b.size();i++){
+            if(b.at(i) == 1) x |= 1u << i;
+            else if(b.at(i) == -1) o |= 1u << i;
+        }
+    }
+
+    // value of playing `cell` for the side to move (board must be covered)
+    DbValue moveValue(const Board& b, uint32_t x, uint32_t o, int cell) const {
+        bool xToMove = b.sideToMove() == 1;
+        uint32_t& mine = xToMove ? x : o;
+        mine |= 1u << cell;
+        if(indexer.hasLineThrough(mine, cell)) return DB_WIN;
+        DbValue child = value(x, o); // for the opponent
+        return child == DB_LOSS ? DB_WIN : child == DB_WIN ? DB_LOSS : child;
+    }
+
+    // per cell 1 win, 0.5 draw, 0 loss for the side to move, -1 occupied;
+    // cells must hold width * height entries
+    void moveValues(const Board& b, float* cells) const {
+        uint32_t x, o;
+        masks(b, x, o);
+        for(int i=0;i<b.size();i++){
+            cells[i] = -1.0f;
+            if(!b.isEmpty(i) || b.result() != 0) continue;
+            DbValue v = moveValue(b, x, o, i);
+            if(v != DB_UNKNOWN) cells[i] = v == DB_WIN ? 1.0f : v == DB_DRAW ? 0.5f : 0.0f;
+        }
+    }
+
+    // a winning move if there is one, else a drawing one, else any; -1 when over.
+    // The table has no distances, so among winning moves it takes one that
+    // wins on the spot first.
+    int bestMove(const Board& b) const {
+        if(b.result() != 0) return -1;
+        uint32_t x, o;
+        masks(b, x, o);
+        int best = -1, bestRank = 0;
+        for(int i=0;i<b.size();i++){
+            if(!b.isEmpty(i)) continue;
+            uint32_t mine = (b.sideToMove() == 1 ? x : o) | 1u << i;
+            if(indexer.hasLineThrough(mine, i)) return i;
+            DbValue v = moveValue(b, x, o, i);
+            int r = v == DB_WIN ? 3 : v == DB_DRAW ? 2 : v == DB_LOSS ? 1 : 0;
+            if(r > bestRank) { bestRank = r; best = i; }
+        }
+        return best;
+    }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    DbHeader header;
+    PositionIndexer indexer;
+};
@@ -0,0 +1,161 @@
+// position_db_gen.cpp
+// Retrograde solver that writes a position_db.h table for a small m,n,k
+// board, e.g. every 4x4 position, or 5x5 endgames from N stones on.
+//
+// Layers are solved from the full board downwards: a position with n
+// stones is over if the player who just moved has a line (a loss for the
+// side to move) or the board is full (a draw); otherwise it is a win if a
+// move completes a line or leads to a loss for the opponent, a draw if a
+// move leads to a draw, else a loss. So layer n only reads layer n + 1.
+// Positions where the side to move already has a line cannot happen and
+// stay DB_UNKNOWN.
+//
+// The output file is created at its final size and memory mapped: each
+// layer is written straight into the mapping and read back from it while
+// the next one down is solved, so memory use is the page cache, not two
+// copies of the biggest layers. Within a layer, threads take chunks of
+// positions from an atomic counter (like record_stats); chunks are a
+// multiple of 4 positions, so no two threads write the same byte.
+//
+// Usage: position_db_gen WIDTH HEIGHT K [--out FILE] [--threads T] [--from STONES]
+//   --from  only solve positions with at least this many stones (endgame table)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "position_db.h"
+
+const uint64_t CHUNK = 1 << 16; // positions per work item, a multiple of 4
+
+struct LayerCounts {
+    uint64_t value[4] = {}; // by DbValue
+};
+
+void solveChunks(const PositionIndexer& idx, int stones, unsigned char* layer, const unsigned char* next,
+                 std::atomic<uint64_t>& nextChunk, LayerCounts& counts) {
+    const uint64_t size = idx.layerSize(stones);
+    const bool xToMove = (stones & 1) == 0;
+    const uint32_t all = idx.cells() == 32 ? 0xFFFFFFFFu : (1u << idx.cells()) - 1;
+    for(;;){
+        uint64_t begin = nextChunk.fetch_add(1) * CHUNK;
+        if(begin >= size) break;
+        uint64_t end = begin + CHUNK < size ? begin + CHUNK : size;
+        for(uint64_t i=begin;i<end;i++){
+            uint32_t x, o;
+            idx.unrank(stones, i, x, o);
+            uint32_t mine = xToMove ? x : o, theirs = xToMove ? o : x;
+            DbValue v;
+            if(idx.hasLine(theirs)) v = idx.hasLine(mine) ? DB_UNKNOWN : DB_LOSS;
+            else if(idx.hasLine(mine)) v = DB_UNKNOWN;
+            else if(stones == idx.cells()) v = DB_DRAW;
+            else {
+                v = DB_LOSS;
+                for(uint32_t empty=~(x | o) & all;empty && v != DB_WIN;empty&=empty-1){
+                    int cell = __builtin_ctz(empty);
+                    uint32_t after = mine | 1u << cell;
+                    if(idx.hasLineThrough(after, cell)) { v = DB_WIN; break; }
+                    DbValue child = getDbValue(next, xToMove ? idx.rank(after, o) : idx.rank(x, after));
+                    if(child == DB_LOSS) v = DB_WIN;
+                    else if(child == DB_DRAW) v = DB_DRAW;
+                }
+            }
+            setDbValue(layer, i, v);
+            counts.value[v]++;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int dims[3], numDims = 0;
+    std::string outPath;
+    int threads = (int)std::thread::hardware_concurrency();
+    int from = 0;
+    for(int i=1;i<argc;i++){
+        std::string arg = argv[i];
+        bool hasValue = i+1 < argc;
+        if(arg == "--out" && hasValue) outPath = argv[++i];
+        else if(arg == "--threads" && hasValue) threads = atoi(argv[++i]);
+        else if(arg == "--from" && hasValue) from = atoi(argv[++i]);
+        else if(numDims < 3 && arg[0] != '-') dims[numDims++] = atoi(argv[i]);
+        else { numDims = -1; break; }
+    }
+    PositionIndexer idx(numDims == 3 ? dims[0] : 0, numDims == 3 ? dims[1] : 0, numDims == 3 ? dims[2] : 0);
+    if(numDims != 3 || !idx.valid() || from < 0 || from > idx.cells()) {
+        fprintf(stderr, "Usage: %s WIDTH HEIGHT K [--out FILE] [--threads T] [--from STONES]\n"
+                        "  at most %d cells; --from solves only positions with that many stones or more\n",
+                argv[0], DB_MAX_CELLS);
+        return 1;
+    }
+    if(threads < 1) threads = 1;
+    if(outPath.empty()) outPath = std::to_string(dims[0]) + "x" + std::to_string(dims[1]) + "k" + std::to_string(dims[2]) + ".tdb";
+
+    DbHeader header;
+    header.width = idx.width();
+    header.height = idx.height();
+    header.k = idx.inARow();
+    header.firstLayer = from;
+    header.cells = idx.cells();
+    uint64_t fileBytes = DB_HEADER_BYTES, total = 0;
+    for(int s=from;s<=idx.cells();s++){
+        header.offset[s] = fileBytes;
+        header.positions[s] = idx.layerSize(s);
+        total += header.positions[s];
+        fileBytes += (dbLayerBytes(header.positions[s]) + DB_PAGE - 1) / DB_PAGE * DB_PAGE;
+    }
+    printf("%dx%d k=%d, layers %d..%d: %llu positions, %.1f MB\n", idx.width(), idx.height(), idx.inARow(),
+           from, idx.cells(), (unsigned long long)total, fileBytes / 1e6);
+
+    int fd = open(outPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0 || ftruncate(fd, (off_t)fileBytes) != 0) {
+        perror(outPath.c_str());
+        return 1;
+    }
+    void* m = mmap(nullptr, fileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(m == MAP_FAILED) { perror("mmap"); return 1; }
+    unsigned char* file = (unsigned char*)m;
+
+    auto start = std::chrono::steady_clock::now();
+    for(int s=idx.cells();s>=from;s--){
+        auto layerStart = std::chrono::steady_clock::now();
+        unsigned char* layer = file + header.offset[s];
+        const unsigned char* next = s < idx.cells() ? file + header.offset[s + 1] : nullptr;
+        std::atomic<uint64_t> nextChunk(0);
+        std::vector<LayerCounts> shards(threads);
+        std::vector<std::thread> pool;
+        for(int t=0;t<threads;t++) pool.emplace_back(solveChunks, std::cref(idx), s, layer, next, std::ref(nextChunk), std::ref(shards[t]));
+        for(auto& th : pool) th.join();
+
+        LayerCounts c;
+        for(const LayerCounts& sh : shards) for(int v=0;v<4;v++) c.value[v] += sh.value[v];
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - layerStart).count();
+        printf("  %2d stones %13llu positions: %12llu win %12llu draw %12llu loss %12llu unreachable  %.2fs\n", s,
+               (unsigned long long)header.positions[s], (unsigned long long)c.value[DB_WIN], (unsigned long long)c.value[DB_DRAW],
+               (unsigned long long)c.value[DB_LOSS], (unsigned long long)c.value[DB_UNKNOWN], seconds);
+    }
+
+    header.encode(file);
+    if(msync(file, fileBytes, MS_SYNC) != 0) { perror("msync"); return 1; }
+    writeDbMagic(file); // only now is the table complete
+    msync(file, DB_PAGE, MS_SYNC);
+    munmap(file, fileBytes);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(from == 0) {
+        static const char* NAMES[4] = {"?", "a win for X", "a draw", "a loss for X"};
+        PositionDb db;
+        if(db.open(outPath)) printf("empty board: %s\n", NAMES[db.value(0, 0)]);
+    }
+    printf("%s written in %.1fs (%.0f positions/s)\n", outPath.c_str(), seconds, total / seconds);
+    return 0;
+}
@@ -0,0 +1,201 @@
+// profiler.h
+// Scoped timing zones, written out as a Chrome trace (chrome://tracing or
+// https://ui.perfetto.dev).
+//
+// PROFILE_ZONE("name") times the rest of the enclosing scope,
+// PROFILE_FUNCTION() is a zone named after the function, and
+// PROFILE_THREAD("name") labels the calling thread in the trace. All three
+// compile to nothing unless PROFILER_ENABLED is defined
+// (-DPROFILER_ENABLED), so the zones stay in the code at no cost.
+//
+// Every thread records into a ring of its own holding the last
+// PROFILER_RING zones: a zone is two clock reads, a store and one release
+// store of the ring's head, no locks and no read-modify-write atomics.
+// The mutex is only taken when a thread records for the first time, names
+// itself and exits, which hands its ring on to the next new thread (MCTS
+// starts its workers per search). A trace track is a ring, not a thread:
+// the threads that take turns on a ring share its id and its track, which
+// is labelled with the latest name given, so short-lived threads grow
+// neither memory nor the number of tracks. Zones that overflow a ring
+// overwrite its oldest ones and are counted as dropped.
+//
+// writeChromeTrace() reads every ring. Call it when the other threads are
+// idle or joined; zones recorded while it runs may be missing or torn.
+// Zone and thread names must be string literals (or otherwise outlive the
+// profiler).
+//
+// No GLFW / OpenGL dependency.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+const uint64_t PROFILER_RING = 1 << 16; // zones kept per thread
+
+struct ProfileZone {
+    const char* name;
+    uint64_t start;    // ns since the profiler started
+    uint64_t duration; // ns
+};
+
+class Profiler {
+public:
+    Profiler() : epoch(std::chrono::steady_clock::now()) {}
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    uint64_t now() const {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    // one finished zone of the calling thread
+    void record(const char* name, uint64_t start, uint64_t end) {
+        Local& l = local();
+        if(!l.ring) attach(l);
+        Ring& r = *l.ring;
+        uint64_t h = r.head.load(std::memory_order_relaxed);
+        r.zones[h % PROFILER_RING] = {name, start, end - start};
+        r.head.store(h + 1, std::memory_order_release);
+    }
+
+    void nameThread(const char* name) {
+        Local& l = local();
+        if(!l.ring) attach(l);
+        std::lock_guard<std::mutex> lock(mutex);
+        l.ring->name = name;
+    }
+
+    uint64_t zones() const { return count(false); }
+    uint64_t dropped() const { return count(true); }
+
+    // every zone still in the rings as complete ("X") events, timestamps in µs
+    bool writeChromeTrace(const std::string& path) const {
+        FILE* f = fopen(path.c_str(), "w");
+        if(!f) return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        const char* sep = "";
+        for(const auto& r : rings) {
+            if(!r->name) continue;
+            fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", sep, r->id);
+            writeEscaped(f, r->name);
+            fprintf(f, "\"}}");
+            sep = ",\n";
+        }
+        for(const auto& r : rings) {
+            uint64_t h = r->head.load(std::memory_order_acquire);
+            for(uint64_t i=h > PROFILER_RING ? h - PROFILER_RING : 0;i<h;i++){
+                const ProfileZone& z = r->zones[i % PROFILER_RING];
+                fprintf(f, "%s{\"name\":\"", sep);
+                writeEscaped(f, z.name);
+                fprintf(f, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", r->id, z.start / 1e3, z.duration / 1e3);
+                sep = ",\n";
+            }
+        }
+        fprintf(f, "\n]}\n");
+        return fclose(f) == 0;
+    }
+
+private:
+    struct Ring {
+        explicit Ring(uint32_t id) : id(id) {}
+        const uint32_t id;             // trace thread id, 1 = the first ring
+        const char* name = nullptr;    // guarded by the mutex
+        std::atomic<uint64_t> head{0}; // zones ever recorded; only its owner thread writes it
+        std::unique_ptr<ProfileZone[]> zones{new ProfileZone[PROFILER_RING]};
+    };
+
+    // the calling thread's ring; handed back when the thread exits
+    struct Local {
+        Profiler* owner = nullptr;
+        Ring* ring = nullptr;
+        ~Local() {
+            if(!ring) return;
+            std::lock_guard<std::mutex> lock(owner->mutex);
+            owner->idle.push_back(ring);
+        }
+    };
+
+    std::chrono::steady_clock::time_point epoch;
+    mutable std::mutex mutex; // guards everything below
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<Ring*> idle; // rings of threads that exited
+
+    static Local& local() {
+        static thread_local Local l;
+        return l;
+    }
+
+    void attach(Local& l) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(idle.empty()) {
+            rings.emplace_back(new Ring((uint32_t)rings.size() + 1));
+            l.ring = rings.back().get();
+        } else {
+            l.ring = idle.back();
+            idle.pop_back();
+        }
+        l.owner = this;
+    }
+
+    uint64_t count(bool overwritten) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t n = 0;
+        for(const auto& r : rings) {
+            uint64_t h = r->head.load(std::memory_order_acquire);
+            n += overwritten ? (h > PROFILER_RING ? h - PROFILER_RING : 0) : (h < PROFILER_RING ? h : PROFILER_RING);
+        }
+        return n;
+    }
+
+    static void writeEscaped(FILE* f, const char* s) {
+        for(;*s;s++){
+            if(*s == '"' || *s == '\\') fputc('\\', f);
+            if((unsigned char)*s >= 0x20) fputc(*s, f);
+        }
+    }
+};
+
+inline Profiler& profiler() {
+    static Profiler p;
+    return p;
+}
+
+#ifdef PROFILER_ENABLED
+
+const bool PROFILER_COMPILED_IN = true;
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : name(name), start(profiler().now()) {}
+    ~ProfileScope() { profiler().record(name, start, profiler().now()); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ProfileScope PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+#define PROFILE_THREAD(name) profiler().nameThread(name)
+
+#else
+
+const bool PROFILER_COMPILED_IN = false;
+
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+
+#endif
@@ -0,0 +1,168 @@
+// record_stats.cpp
+// Statistics over a game record file (game_record.h): results, game
+// lengths, opening frequencies and the win rate by first move.
+//
+// The file is memory mapped and scanned in place: blocks are dealt out to
+// the threads (an atomic block counter), every thread counts into its own
+// arrays, and the shards are only added together after join(), like
+// simulator. No game is copied or allocated, so hundreds of millions of
+// games are a matter of seconds and of the page cache.
+//
+// Usage: record_stats FILE [--threads T] [--top N] [--verify]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "game_record.h"
+
+// two-move openings are counted in a cells x cells table up to this board
+// size (512 KB per thread), in a hash map of the ones that occur above it
+const int DENSE_OPENINGS_MAX_CELLS = 256;
+
+struct RecordStats {
+    uint64_t games = 0, moves = 0, badBlocks = 0;
+    uint64_t results[4] = {};              // by 2-bit code: unfinished, X, O, draw
+    std::vector<uint64_t> lengths;         // games by number of moves
+    std::vector<uint64_t> firstMove;       // [cell * 4 + code]
+    std::vector<uint64_t> openings;        // [first * cells + second], small boards
+    std::unordered_map<uint32_t, uint64_t> sparseOpenings; // same key, big boards
+
+    explicit RecordStats(int cells = 9)
+        : lengths(cells + 1, 0), firstMove(cells * 4, 0),
+          openings(cells <= DENSE_OPENINGS_MAX_CELLS ? cells * cells : 0, 0) {}
+
+    void addOpening(uint32_t key) {
+        if(key < openings.size()) openings[key]++;
+        else sparseOpenings[key]++;
+    }
+
+    void add(const RecordStats& o) {
+        games += o.games; moves += o.moves; badBlocks += o.badBlocks;
+        for(int i=0;i<4;i++) results[i] += o.results[i];
+        for(size_t i=0;i<lengths.size();i++) lengths[i] += o.lengths[i];
+        for(size_t i=0;i<firstMove.size();i++) firstMove[i] += o.firstMove[i];
+        for(size_t i=0;i<openings.size();i++) openings[i] += o.openings[i];
+        for(const auto& e : o.sparseOpenings) sparseOpenings[e.first] += e.second;
+    }
+};
+
+void scanBlocks(const GameRecordReader& reader, std::atomic<size_t>& nextBlock, bool verify, RecordStats& st) {
+    const std::vector<RecordBlockInfo>& blocks = reader.blocks();
+    const int cells = reader.recordBoard().cells();
+    for(;;){
+        size_t b = nextBlock.fetch_add(1);
+        if(b >= blocks.size()) break;
+        if(verify && !reader.verify(blocks[b])) { st.badBlocks++; continue; }
+        reader.forEachGame(blocks[b], [&](const GameView& g) {
+            int code = resultToCode(g.result);
+            st.games++;
+            st.moves += g.moveCount;
+            st.results[code]++;
+            st.lengths[std::min(g.moveCount, cells)]++;
+            if(g.moveCount == 0) return;
+            int first = g.move(0);
+            if(first >= cells) return;
+            st.firstMove[first * 4 + code]++;
+            if(g.moveCount > 1 && g.move(1) < cells) st.addOpening((uint32_t)(first * cells + g.move(1)));
+        });
+    }
+}
+
+// "c4" style name: column letter, row number from the top
+std::string cellName(int cell, int width) {
+    std::string s(1, (char)('a' + cell % width));
+    return s + std::to_string(cell / width + 1);
+}
+
+int main(int argc, char** argv) {
+    std::string path;
+    int threads = (int)std::thread::hardware_concurrency();
+    int top = 10;
+    bool verify = false;
+
+    for(int i=1;i<argc;i++){
+        std::string arg = argv[i];
+        bool hasValue = i+1 < argc;
+        if(arg == "--threads" && hasValue) threads = atoi(argv[++i]);
+        else if(arg == "--top" && hasValue) top = atoi(argv[++i]);
+        else if(arg == "--verify") verify = true;
+        else if(path.empty() && arg[0] != '-') path = arg;
+        else { path.clear(); break; }
+    }
+    if(path.empty() || top < 0) {
+        fprintf(stderr, "Usage: %s FILE [--threads T] [--top N] [--verify]\n"
+                        "  --top     number of two-move openings to list (default 10, >= 0)\n"
+                        "  --verify  check every block's checksum\n", argv[0]);
+        return 1;
+    }
+    if(threads < 1) threads = 1;
+
+    GameRecordReader reader;
+    if(!reader.open(path)) return 1;
+    const RecordBoard& board = reader.recordBoard();
+    const int cells = board.cells();
+
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> nextBlock(0);
+    std::vector<RecordStats> shards(threads, RecordStats(cells));
+    std::vector<std::thread> pool;
+    for(int t=0;t<threads;t++) pool.emplace_back(scanBlocks, std::cref(reader), std::ref(nextBlock), verify, std::ref(shards[t]));
+    for(auto& th : pool) th.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    RecordStats total(cells);
+    for(const RecordStats& s : shards) total.add(s);
+
+    double n = total.games ? (double)total.games : 1.0;
+    printf("%s: %dx%d k=%d, %llu games in %zu blocks, %.1f MB (%.2f bytes/game)\n", path.c_str(),
+           board.width, board.height, board.k, (unsigned long long)total.games, reader.blocks().size(),
+           reader.fileBytes() / 1e6, reader.fileBytes() / n);
+    if(reader.ignoredBytes()) printf("  ignored %zu bytes of an incomplete last block\n", reader.ignoredBytes());
+    if(total.badBlocks) printf("  %llu blocks failed the checksum and were skipped\n", (unsigned long long)total.badBlocks);
+    printf("  X wins: %12llu (%6.2f%%)\n", (unsigned long long)total.results[1], 100.0 * total.results[1] / n);
+    printf("  O wins: %12llu (%6.2f%%)\n", (unsigned long long)total.results[2], 100.0 * total.results[2] / n);
+    printf("  draws:  %12llu (%6.2f%%)\n", (unsigned long long)total.results[3], 100.0 * total.results[3] / n);
+    if(total.results[0]) printf("  unfinished: %8llu\n", (unsigned long long)total.results[0]);
+    printf("  avg moves per game: %.2f\n", total.moves / n);
+
+    printf("\nlength    games\n");
+    for(int l=0;l<=cells;l++){
+        if(total.lengths[l]) printf("%6d %12llu (%6.2f%%)\n", l, (unsigned long long)total.lengths[l], 100.0 * total.lengths[l] / n);
+    }
+
+    printf("\nfirst move     games    share   X wins   O wins    draws\n");
+    for(int c=0;c<cells;c++){
+        const uint64_t* r = &total.firstMove[c * 4];
+        uint64_t g = r[0] + r[1] + r[2] + r[3];
+        if(!g) continue;
+        printf("%-10s %9llu  %6.2f%%  %6.2f%%  %6.2f%%  %6.2f%%\n", cellName(c, board.width).c_str(),
+               (unsigned long long)g, 100.0 * g / n, 100.0 * r[1] / g, 100.0 * r[2] / g, 100.0 * r[3] / g);
+    }
+
+    std::vector<std::pair<uint64_t, uint32_t>> order; // games, opening
+    for(size_t i=0;i<total.openings.size();i++) if(total.openings[i]) order.emplace_back(total.openings[i], (uint32_t)i);
+    for(const auto& e : total.sparseOpenings) order.emplace_back(e.second, e.first);
+    size_t shown = std::min((size_t)top, order.size());
+    std::partial_sort(order.begin(), order.begin() + shown, order.end(),
+                      [](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) {
+                          return a.first != b.first ? a.first > b.first : a.second < b.second;
+                      });
+    printf("\nopening        games    share\n");
+    for(size_t i=0;i<shown;i++){
+        uint32_t o = order[i].second;
+        std::string name = cellName(o / cells, board.width) + " " + cellName(o % cells, board.width);
+        printf("%-10s %9llu  %6.2f%%\n", name.c_str(), (unsigned long long)order[i].first, 100.0 * order[i].first / n);
+    }
+
+    printf("\n%.3fs on %d threads, %.0f games/s\n", seconds, threads, total.games / seconds);
+    return 0;
+}
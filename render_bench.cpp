@@ -0,0 +1,166 @@
+// render_bench.cpp
+// Offscreen frame-time benchmark for the renderers (no window needed).
+//
+// Renders a fixed set of scenes into an offscreen framebuffer
+// (offscreen.h: EGL surfaceless + FBO, works on Mesa llvmpipe) for N frames
+// each and reports min / median / p99 frame time and draw calls per frame:
+//   - the Three-in-a-Row board (board_renderer.h) in every game state,
+//     plus two large m,n,k boards (board_scenes.h)
+//   - the modern_gl_a1 shape scene (shape_scene.h)
+//   - random stress scenes of --stress N shapes, optionally also drawn
+//     with one draw call per shape (--unbatched)
+//
+// A frame is timed from glClear to the end of glFinish(), so it includes the
+// GPU (or llvmpipe) work, not just command submission. Run it from this
+// folder so the shaders/ paths resolve.
+//
+// Usage: render_bench [--frames N] [--size WxH] [--stress N]... [--unbatched] [--scene TEXT]
+
+#include <GLAD/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "offscreen.h"
+#include "board.h"
+#include "board_renderer.h"
+#include "board_scenes.h"
+#include "shape_renderer.h"
+#include "shape_scene.h"
+
+struct BenchScene {
+    std::string name;
+    std::function<void()> setup;          // once, before the warm-up frames
+    std::function<void(int frame)> draw;  // one frame
+    std::function<size_t()> drawCalls;    // draw calls of the last frame
+};
+
+struct FrameStats {
+    double minMs = 0.0, medianMs = 0.0, p99Ms = 0.0, meanMs = 0.0;
+};
+
+FrameStats summarize(std::vector<double>& ms) {
+    FrameStats s;
+    if(ms.empty()) return s;
+    std::sort(ms.begin(), ms.end());
+    s.minMs = ms.front();
+    s.medianMs = ms[ms.size() / 2];
+    size_t p99 = (size_t)std::ceil(ms.size() * 0.99) - 1;
+    s.p99Ms = ms[std::min(p99, ms.size() - 1)];
+    for(double m : ms) s.meanMs += m;
+    s.meanMs /= ms.size();
+    return s;
+}
+
+int main(int argc, char** argv) {
+    int frames = 100;
+    int warmup = 5;
+    int width = 800, height = 800;
+    std::vector<int> stressCounts;
+    bool unbatched = false;
+    std::string filter;
+
+    for(int i=1;i<argc;i++){
+        std::string arg = argv[i];
+        bool hasValue = i+1 < argc;
+        if(arg == "--frames" && hasValue) frames = atoi(argv[++i]);
+        else if(arg == "--size" && hasValue && sscanf(argv[i+1], "%dx%d", &width, &height) == 2) i++;
+        else if(arg == "--stress" && hasValue) stressCounts.push_back(atoi(argv[++i]));
+        else if(arg == "--unbatched") unbatched = true;
+        else if(arg == "--scene" && hasValue) filter = argv[++i];
+        else {
+            fprintf(stderr, "Usage: %s [--frames N] [--size WxH] [--stress N]... [--unbatched] [--scene TEXT]\n"
+                            "  --stress may be given several times (default: 1000 and 10000 shapes)\n"
+                            "  --scene only runs scenes whose name contains TEXT\n", argv[0]);
+            return 1;
+        }
+    }
+    if(frames < 1) frames = 1;
+    if(stressCounts.empty()) stressCounts = {1000, 10000};
+
+    OffscreenContext offscreen;
+    if(!offscreen.init(width, height)) return 1;
+
+    BoardRenderer boardRenderer;
+    ShapeRenderer shapes;
+    if(!boardRenderer.init() || !shapes.init(360)) {
+        offscreen.destroy();
+        return 1;
+    }
+
+    Board board;
+    BoardScene boardScene;
+    std::vector<BenchScene> scenes;
+
+    // --- the board in every state ---
+    for(const BoardSceneCase& c : boardSceneCases()) {
+        scenes.push_back({c.name,
+            [&]() { loadBoardSceneCase(c, board, boardScene); },
+            [&](int) { drawBoardFrame(boardRenderer, boardScene, width, height); },
+            [&]() { return boardRenderer.drawCalls(); }});
+    }
+
+    // --- shapes ---
+    const GLfloat identity[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
+    scenes.push_back({"shapes default",
+        [&]() { shapes.clear(); addDefaultShapes(shapes); },
+        [&](int) { drawShapeFrame(shapes, identity); },
+        [&]() { return shapes.drawCalls(); }});
+
+    // the stress scenes spin like `modern_gl_a1 --stress`, one fixed step per frame
+    auto spin = [](int frame, GLfloat* mvp) {
+        float angle = frame * 0.01f;
+        float c = std::cos(angle), s = std::sin(angle);
+        const GLfloat m[16] = {c,s,0,0, -s,c,0,0, 0,0,1,0, 0,0,0,1};
+        std::copy(m, m + 16, mvp);
+    };
+    for(int count : stressCounts) {
+        for(int pass=0;pass<(unbatched ? 2 : 1);pass++){
+            bool single = pass == 1;
+            scenes.push_back({"stress " + std::to_string(count) + (single ? " unbatched" : ""),
+                [&shapes, count]() { shapes.clear(); addStressShapes(shapes, count); },
+                [&shapes, spin, single](int frame) {
+                    GLfloat mvp[16];
+                    spin(frame, mvp);
+                    drawShapeFrame(shapes, mvp, single);
+                },
+                [&shapes]() { return shapes.drawCalls(); }});
+        }
+    }
+
+    printf("%s, %dx%d, %d frames per scene (+%d warm-up)\n",
+           offscreen.rendererName(), width, height, frames, warmup);
+    printf("%-26s %9s %9s %9s %9s %8s\n", "scene", "min ms", "median", "p99", "mean", "draws");
+
+    using clock = std::chrono::steady_clock;
+    std::vector<double> ms;
+    for(BenchScene& scene : scenes) {
+        if(!filter.empty() && scene.name.find(filter) == std::string::npos) continue;
+        scene.setup();
+        ms.clear();
+        for(int f=-warmup;f<frames;f++){
+            auto start = clock::now();
+            scene.draw(f);
+            glFinish();
+            if(f >= 0) ms.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+        }
+        FrameStats s = summarize(ms);
+        printf("%-26s %9.3f %9.3f %9.3f %9.3f %8zu\n", scene.name.c_str(),
+               s.minMs, s.medianMs, s.p99Ms, s.meanMs, scene.drawCalls());
+    }
+
+    GLenum err = glGetError();
+    if(err != GL_NO_ERROR) fprintf(stderr, "OpenGL error 0x%x\n", err);
+
+    shapes.destroy();
+    boardRenderer.destroy();
+    shaderCache().clear();
+    offscreen.destroy();
+    return err == GL_NO_ERROR ? 0 : 1;
+}
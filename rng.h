@@ -0,0 +1,35 @@
+// rng.h
+// Small, fast per-thread random number generator (xorshift64*).
+//
+// Each worker owns its own Rng, so there is no shared state and no locking
+// between threads. Not suitable for anything security related.
+
+#pragma once
+
+#include <cstdint>
+
+struct Rng {
+    uint64_t state;
+
+    explicit Rng(uint64_t seed = 0x9E3779B97F4A7C15ull) { reseed(seed); }
+
+    // splitmix64 the seed so neighbouring seeds (thread ids) diverge
+    void reseed(uint64_t seed) {
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state = (z ^ (z >> 31)) | 1; // never zero
+    }
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+
+    // uniform integer in [0, n)
+    uint32_t below(uint32_t n) {
+        return (uint32_t)(((next() >> 32) * (uint64_t)n) >> 32);
+    }
+};
@@ -0,0 +1,129 @@
+// search_bench.cpp
+// Nodes per second of a full-width tree walk (perft) with SearchState's
+// make / unmake (search_state.h) against copying a Board per node, the way
+// a search written on top of main.cpp's board would.
+//
+// Both walks visit the same tree: every legal move from the start
+// position down to --depth plies, stopping at finished games, and count
+// the nodes. --verify additionally runs the two side by side and checks at
+// every node that the incremental hash equals one recomputed from the
+// cells and that both agree on the result, then that the root state is
+// restored exactly.
+//
+// Usage: search_bench [width height k] [--depth D] [--moves M] [--seed S] [--verify]
+//   --moves plays M random opening moves first (big boards)
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "board.h"
+#include "rng.h"
+#include "search_state.h"
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t perft(SearchState& s, int depth) {
+    uint64_t nodes = 1;
+    if(depth == 0) return nodes;
+    int count = s.moveListSize();
+    for(int i=0;i<count;i++){
+        int cell = s.moves()[i];
+        s.make(cell);
+        nodes += perft(s, depth - 1);
+        s.unmake();
+    }
+    return nodes;
+}
+
+// the copy-per-node way: the child is a fresh Board
+uint64_t perftCopy(const Board& b, int depth) {
+    uint64_t nodes = 1;
+    if(depth == 0 || b.result() != 0) return nodes;
+    for(int cell=0;cell<b.size();cell++){
+        if(!b.isEmpty(cell)) continue;
+        Board child = b;
+        child.play(cell, child.sideToMove());
+        nodes += perftCopy(child, depth - 1);
+    }
+    return nodes;
+}
+
+uint64_t verifyErrors = 0;
+
+// both side by side; Board is played in the order SearchState lists its moves
+uint64_t perftVerify(SearchState& s, const Board& b, int depth) {
+    if(s.hash() != s.computeHash() || s.result() != b.result() || s.sideToMove() != b.sideToMove()) {
+        if(verifyErrors++ < 5) fprintf(stderr, "mismatch at ply %d: hash %016llx / %016llx, result %d / %d\n", s.ply(),
+                                       (unsigned long long)s.hash(), (unsigned long long)s.computeHash(), s.result(), b.result());
+    }
+    uint64_t nodes = 1;
+    if(depth == 0) return nodes;
+    int count = s.moveListSize();
+    for(int i=0;i<count;i++){
+        int cell = s.moves()[i];
+        Board child = b;
+        child.play(cell, child.sideToMove());
+        s.make(cell);
+        nodes += perftVerify(s, child, depth - 1);
+        s.unmake();
+    }
+    return nodes;
+}
+
+template <class F>
+void timed(const char* name, F f) {
+    auto start = Clock::now();
+    uint64_t nodes = f();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    printf("%-24s %14llu nodes %8.3fs %8.1f M nodes/s\n", name, (unsigned long long)nodes, seconds,
+           seconds > 0.0 ? nodes / seconds / 1e6 : 0.0);
+}
+
+int main(int argc, char** argv) {
+    int dims[3] = {3, 3, 3}, numDims = 0;
+    int depth = -1, openingMoves = 0;
+    uint64_t seed = 1;
+    bool verify = false;
+    for(int i=1;i<argc;i++){
+        std::string arg = argv[i];
+        bool hasValue = i+1 < argc;
+        if(arg == "--depth" && hasValue) depth = atoi(argv[++i]);
+        else if(arg == "--moves" && hasValue) openingMoves = atoi(argv[++i]);
+        else if(arg == "--seed" && hasValue) seed = strtoull(argv[++i], NULL, 10);
+        else if(arg == "--verify") verify = true;
+        else if(numDims < 3 && arg[0] != '-') dims[numDims++] = atoi(argv[i]);
+        else { numDims = -1; break; }
+    }
+    SearchState state(dims[0], dims[1], dims[2]);
+    if((numDims != 0 && numDims != 3) || dims[0] < 1 || dims[1] < 1 || dims[2] < 1 || !state.fits()) {
+        fprintf(stderr, "Usage: %s [width height k] [--depth D] [--moves M] [--seed S] [--verify]\n"
+                        "  at most %d cells; --depth defaults to the whole game on 3x3, 4 otherwise\n",
+                argv[0], SEARCH_MAX_CELLS);
+        return 1;
+    }
+    Board board(dims[0], dims[1], dims[2]);
+    if(depth < 0) depth = board.isClassic() ? 9 : 4;
+
+    Rng rng(seed);
+    for(int m=0;m<openingMoves && board.result() == 0;){
+        int cell = (int)rng.below((uint32_t)board.size());
+        if(!board.isEmpty(cell)) continue;
+        board.play(cell, board.sideToMove());
+        m++;
+    }
+    state.setPosition(board);
+    uint64_t rootHash = state.hash();
+
+    printf("%dx%d k=%d, %d stones, depth %d\n", board.width(), board.height(), board.inARow(), board.moveCount(), depth);
+    timed("make/unmake", [&]() { return perft(state, depth); });
+    timed("Board copy per node", [&]() { return perftCopy(board, depth); });
+    if(verify) {
+        uint64_t nodes = perftVerify(state, board, depth);
+        if(state.hash() != rootHash || state.ply() != board.moveCount()) verifyErrors++;
+        printf("verify: %llu nodes, %llu mismatches\n", (unsigned long long)nodes, (unsigned long long)verifyErrors);
+    }
+    return verifyErrors ? 1 : 0;
+}
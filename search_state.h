@@ -0,0 +1,194 @@
+// search_state.h
+// Make / unmake game state for tree searches on any m,n,k board.
+//
+// Board (board.h) is a value type: a search that copies it per node pays
+// for the cell vector, and Board::play() walks up to k cells in four
+// directions to detect a win. SearchState instead keeps, updated on every
+// move and undone by unmake():
+//  - a 64-bit Zobrist hash (one random key per cell and side, plus one for
+//    the side to move), for transposition tables;
+//  - X and O stone counts for every k-cell line, so a move only bumps the
+//    counters of the lines through its cell and wins when one reaches k;
+//  - the list of empty cells (swap-remove, restored exactly on unmake), so
+//    move generation is a pointer and a count;
+//  - a fixed-capacity undo stack.
+// Everything is sized in the constructor; make(), unmake() and the
+// accessors never allocate. Boards of up to SEARCH_MAX_CELLS cells.
+//
+// No GLFW / OpenGL dependency.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+#include "rng.h"
+
+const int SEARCH_MAX_CELLS = 1024; // 32x32
+
+// Zobrist keys, the same for every board size
+struct ZobristKeys {
+    uint64_t stone[SEARCH_MAX_CELLS][2]; // [cell][0 = X, 1 = O]
+    uint64_t oToMove;
+
+    ZobristKeys() {
+        Rng rng(0x5EA4C4);
+        for(int i=0;i<SEARCH_MAX_CELLS;i++){
+            stone[i][0] = rng.next();
+            stone[i][1] = rng.next();
+        }
+        oToMove = rng.next();
+    }
+};
+
+inline const ZobristKeys& zobristKeys() {
+    static const ZobristKeys keys;
+    return keys;
+}
+
+class SearchState {
+public:
+    explicit SearchState(int width = 3, int height = 3, int k = 3)
+        : w(width), h(height), k(k), n(width * height), keys(zobristKeys()) {
+        // every k-cell window in the four directions, and the windows through each cell
+        static const int DIRS[4][2] = {{0,1},{1,0},{1,1},{1,-1}};
+        std::vector<std::vector<uint16_t>> through(n);
+        int lines = 0;
+        for(int r=0;r<h;r++){
+            for(int c=0;c<w;c++){
+                for(const auto& d : DIRS) {
+                    int er = r + d[0] * (k - 1), ec = c + d[1] * (k - 1);
+                    if(er < 0 || er >= h || ec < 0 || ec >= w) continue;
+                    for(int i=0;i<k;i++) through[(r + d[0] * i) * w + c + d[1] * i].push_back((uint16_t)lines);
+                    lines++;
+                }
+            }
+        }
+        lineStart.assign(n + 1, 0);
+        for(int i=0;i<n;i++) lineStart[i + 1] = lineStart[i] + (int)through[i].size();
+        lineIds.reserve(lineStart[n]);
+        for(const auto& t : through) lineIds.insert(lineIds.end(), t.begin(), t.end());
+        counts[0].assign(lines, 0);
+        counts[1].assign(lines, 0);
+        cells.assign(n, 0);
+        emptyList.resize(n);
+        emptyPos.resize(n);
+        reset();
+    }
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int inARow() const { return k; }
+    int size() const { return n; }
+    bool fits() const { return n <= SEARCH_MAX_CELLS; } // check once after constructing
+
+    void reset() {
+        for(int i=0;i<n;i++){
+            cells[i] = 0;
+            emptyList[i] = (int16_t)i;
+            emptyPos[i] = (int16_t)i;
+        }
+        for(auto& c : counts) std::fill(c.begin(), c.end(), 0);
+        empties = n;
+        depth = 0;
+        state = 0;
+        key = 0;
+    }
+
+    // take over a Board's position; X and O stones are replayed in
+    // alternation, since the order does not change the state. Allocates,
+    // meant for setting up the root.
+    void setPosition(const Board& b) {
+        reset();
+        std::vector<int> stones[2]; // X, O
+        for(int i=0;i<n;i++) if(b.at(i) != 0) stones[b.at(i) == 1 ? 0 : 1].push_back(i);
+        for(size_t i=0;i<stones[0].size() || i<stones[1].size();i++){
+            if(i < stones[0].size()) make(stones[0][i]);
+            if(i < stones[1].size()) make(stones[1][i]);
+        }
+    }
+
+    int at(int idx) const { return cells[idx]; }
+    bool isEmpty(int idx) const { return cells[idx] == 0; }
+    int moveCount() const { return n - empties; }
+    int ply() const { return depth; } // moves made since reset()
+    int sideToMove() const { return ((n - empties) & 1) ? -1 : 1; }
+    // 0 still playing, 1 X wins, -1 O wins, 2 draw
+    int result() const { return state; }
+    uint64_t hash() const { return key; }
+
+    // legal moves: the empty cells, in no particular order; none once the game is over
+    const int16_t* moves() const { return emptyList.data(); }
+    int moveListSize() const { return state == 0 ? empties : 0; }
+
+    // the side to move plays the empty cell idx
+    void make(int idx) {
+        int player = sideToMove();
+        int side = player == 1 ? 0 : 1;
+        undo[depth++] = {(int16_t)idx, (int8_t)state};
+        cells[idx] = (int8_t)player;
+        key ^= keys.stone[idx][side] ^ keys.oToMove;
+
+        int at = emptyPos[idx];
+        int16_t moved = emptyList[--empties];
+        emptyList[at] = moved;
+        emptyPos[moved] = (int16_t)at;
+
+        uint8_t* count = counts[side].data();
+        bool line = false;
+        for(int i=lineStart[idx], end=lineStart[idx + 1];i<end;i++) line |= ++count[lineIds[i]] == k;
+        if(state == 0) state = line ? player : empties == 0 ? 2 : 0;
+    }
+
+    // take back the last make()
+    void unmake() {
+        const Undo& u = undo[--depth];
+        int idx = u.cell;
+        int side = cells[idx] == 1 ? 0 : 1;
+        uint8_t* count = counts[side].data();
+        for(int i=lineStart[idx], end=lineStart[idx + 1];i<end;i++) count[lineIds[i]]--;
+
+        // put the cell back where it was; the one that took its slot goes back to the end
+        int at = emptyPos[idx];
+        int16_t moved = emptyList[at];
+        emptyList[empties] = moved;
+        emptyPos[moved] = (int16_t)empties;
+        emptyList[at] = (int16_t)idx;
+        emptyPos[idx] = (int16_t)at;
+        empties++;
+
+        key ^= keys.stone[idx][side] ^ keys.oToMove;
+        cells[idx] = 0;
+        state = u.result;
+    }
+
+    // the hash recomputed from the cells, for checking the incremental one
+    uint64_t computeHash() const {
+        uint64_t z = 0;
+        for(int i=0;i<n;i++) if(cells[i] != 0) z ^= keys.stone[i][cells[i] == 1 ? 0 : 1];
+        if(sideToMove() == -1) z ^= keys.oToMove;
+        return z;
+    }
+
+private:
+    struct Undo {
+        int16_t cell;
+        int8_t result; // state before the move
+    };
+
+    int w, h, k, n;
+    const ZobristKeys& keys;
+    std::vector<int8_t> cells;               // 0, 1 = X, -1 = O
+    std::vector<int> lineStart;              // lines through cell i: lineIds[lineStart[i] .. lineStart[i+1])
+    std::vector<uint16_t> lineIds;
+    std::vector<uint8_t> counts[2];          // per line: X stones, O stones
+    std::vector<int16_t> emptyList, emptyPos;
+    int empties = 0;
+    std::array<Undo, SEARCH_MAX_CELLS> undo;
+    int depth = 0;
+    int state = 0;
+    uint64_t key = 0;
+};
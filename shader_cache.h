@@ -0,0 +1,416 @@
+// shader_cache.h
+// Shared shader program manager on top of shader_util.h.
+//
+//  - Programs are keyed by an FNV-1a hash of their sources, so loading the
+//    same shaders twice (from the same or different files) returns the same
+//    program, and identical shader stages are compiled only once.
+//  - Linked programs are saved with glGetProgramBinary into a cache folder
+//    (default "shader_cache/") and loaded from there on the next start,
+//    skipping compilation. The key also covers GL_RENDERER / GL_VERSION, so
+//    a driver update simply misses the cache.
+//  - uniform() caches glGetUniformLocation results per program.
+//  - poll() reloads programs whose shader files changed on disk (inotify on
+//    Linux, modification times elsewhere). A reloaded program keeps its GL
+//    name: the new sources are compiled and test-linked first and only then
+//    relinked into the existing program, so a broken edit keeps the last
+//    good version running.
+//
+// One cache per GL context; shaderCache() is the one the programs share.
+// Programs are owned by the cache and freed by clear(). Include this after
+// the OpenGL loader.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include "profiler.h"
+#include "shader_util.h"
+
+inline uint64_t fnv1a64(const std::string& data, uint64_t hash = 0xCBF29CE484222325ull) {
+    for(unsigned char c : data) {
+        hash ^= c;
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+class ShaderCache {
+public:
+    explicit ShaderCache(const std::string& binaryDir = "shader_cache") : binaryDir(binaryDir) {}
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+    ~ShaderCache() { closeWatch(); }
+
+    // program from two shader files, 0 on errors
+    GLuint load(const std::string& vertexPath, const std::string& fragmentPath) {
+        std::string vertexSource = readShaderFile(vertexPath);
+        std::string fragmentSource = readShaderFile(fragmentPath);
+        if(vertexSource.empty() || fragmentSource.empty()) return 0;
+        GLuint program = get(vertexSource, fragmentSource);
+        if(program != 0) {
+            Program& p = programs[program];
+            if(p.vertexPath.empty()) {
+                p.vertexPath = vertexPath;
+                p.fragmentPath = fragmentPath;
+                p.vertexTime = modifiedTime(vertexPath);
+                p.fragmentTime = modifiedTime(fragmentPath);
+                if(watching) addWatch(p);
+            }
+        }
+        return program;
+    }
+
+    // program from in-memory sources, 0 on errors
+    GLuint loadSource(const std::string& vertexSource, const std::string& fragmentSource) {
+        return get(vertexSource, fragmentSource);
+    }
+
+    // cached glGetUniformLocation
+    GLint uniform(GLuint program, const std::string& name) {
+        auto it = programs.find(program);
+        if(it == programs.end()) return glGetUniformLocation(program, name.c_str());
+        auto& locations = it->second.uniforms;
+        auto loc = locations.find(name);
+        if(loc != locations.end()) return loc->second;
+        GLint l = glGetUniformLocation(program, name.c_str());
+        locations.emplace(name, l);
+        return l;
+    }
+
+    // start watching the shader files of every loaded (and later) program
+    void watch() {
+        if(watching) return;
+        watching = true;
+#ifdef __linux__
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+        for(auto& entry : programs) addWatch(entry.second);
+    }
+
+    // reload programs whose files changed since the last call; returns how
+    // many were reloaded. Cheap enough to call every frame.
+    int poll() {
+        if(!watching) return 0;
+        std::vector<GLuint> changed;
+#ifdef __linux__
+        if(inotifyFd >= 0) {
+            alignas(inotify_event) char buf[4096];
+            ssize_t n;
+            while((n = read(inotifyFd, buf, sizeof(buf))) > 0) {
+                for(char* p = buf; p < buf + n; ) {
+                    const inotify_event* ev = (const inotify_event*)p;
+                    p += sizeof(inotify_event) + ev->len;
+                    if(ev->len == 0) continue;
+                    auto dir = watchedDirs.find(ev->wd);
+                    if(dir == watchedDirs.end()) continue;
+                    for(auto& entry : programs) {
+                        const Program& prog = entry.second;
+                        if(prog.vertexPath.empty()) continue;
+                        if(sameFile(prog.vertexPath, dir->second, ev->name) ||
+                           sameFile(prog.fragmentPath, dir->second, ev->name))
+                            changed.push_back(entry.first);
+                    }
+                }
+            }
+        } else
+#endif
+        {
+            for(auto& entry : programs) {
+                Program& prog = entry.second;
+                if(prog.vertexPath.empty()) continue;
+                if(modifiedTime(prog.vertexPath) != prog.vertexTime ||
+                   modifiedTime(prog.fragmentPath) != prog.fragmentTime)
+                    changed.push_back(entry.first);
+            }
+        }
+
+        int reloaded = 0;
+        for(size_t i=0;i<changed.size();i++){
+            bool seen = false;
+            for(size_t j=0;j<i;j++) seen = seen || changed[j] == changed[i];
+            if(!seen && reload(changed[i])) reloaded++;
+        }
+        return reloaded;
+    }
+
+    // number of programs and of compiles skipped thanks to the binary cache
+    size_t programCount() const { return programs.size(); }
+    int binaryHits() const { return hits; }
+
+    // delete every program and shader; call before destroying the context
+    void clear() {
+        for(auto& entry : programs) glDeleteProgram(entry.first);
+        for(auto& entry : shaders) glDeleteShader(entry.second);
+        programs.clear();
+        bySource.clear();
+        shaders.clear();
+        driver.clear();
+        binarySupport = -1;
+    }
+
+private:
+    struct Program {
+        uint64_t key = 0;
+        std::string vertexPath, fragmentPath; // empty for loadSource()
+        time_t vertexTime = 0, fragmentTime = 0;
+        std::unordered_map<std::string, GLint> uniforms;
+    };
+
+    struct BinaryHeader {
+        uint32_t magic;
+        uint32_t format;
+        uint64_t key;
+    };
+    static constexpr uint32_t BINARY_MAGIC = 0x31425453; // "STB1"
+
+    std::string binaryDir;
+    std::string driver;                            // GL_RENDERER|GL_VERSION, part of every key
+    std::unordered_map<GLuint, Program> programs;
+    std::unordered_map<uint64_t, GLuint> bySource; // program key -> program
+    std::unordered_map<uint64_t, GLuint> shaders;  // stage source hash -> shader
+    int hits = 0;
+    int binarySupport = -1;                        // -1 unknown, 0 no, 1 yes
+    bool watching = false;
+#ifdef __linux__
+    int inotifyFd = -1;
+    std::unordered_map<int, std::string> watchedDirs; // watch descriptor -> directory
+#endif
+
+    uint64_t programKey(const std::string& vertexSource, const std::string& fragmentSource) {
+        if(driver.empty())
+            driver = std::string((const char*)glGetString(GL_RENDERER)) + "|" + (const char*)glGetString(GL_VERSION);
+        uint64_t h = fnv1a64(vertexSource);
+        h = fnv1a64(std::string(1, '\0') + fragmentSource, h);
+        return fnv1a64(driver, h);
+    }
+
+    GLuint get(const std::string& vertexSource, const std::string& fragmentSource) {
+        PROFILE_ZONE("ShaderCache::get");
+        uint64_t key = programKey(vertexSource, fragmentSource);
+        auto found = bySource.find(key);
+        if(found != bySource.end()) return found->second;
+
+        GLuint program = loadBinary(key);
+        if(program == 0) {
+            GLuint vs = shader(GL_VERTEX_SHADER, vertexSource);
+            GLuint fs = shader(GL_FRAGMENT_SHADER, fragmentSource);
+            if(vs == 0 || fs == 0) return 0;
+            program = glCreateProgram();
+            markRetrievable(program);
+            if(linkProgram(vs, fs, program) == 0) return 0;
+            glDetachShader(program, vs);
+            glDetachShader(program, fs);
+            saveBinary(program, key);
+        }
+        programs[program].key = key;
+        bySource[key] = program;
+        return program;
+    }
+
+    // compiled shader stage, shared between programs with the same source
+    GLuint shader(GLenum type, const std::string& source) {
+        uint64_t h = fnv1a64(std::to_string(type) + ":" + source);
+        auto found = shaders.find(h);
+        if(found != shaders.end()) return found->second;
+        GLuint s = compileShader(type, source);
+        if(s != 0) shaders[h] = s;
+        return s;
+    }
+
+    bool reload(GLuint program) {
+        PROFILE_ZONE("ShaderCache::reload");
+        Program& p = programs[program];
+        p.vertexTime = modifiedTime(p.vertexPath);
+        p.fragmentTime = modifiedTime(p.fragmentPath);
+        std::string vertexSource = readShaderFile(p.vertexPath);
+        std::string fragmentSource = readShaderFile(p.fragmentPath);
+        if(vertexSource.empty() || fragmentSource.empty()) return false; // mid-save
+        uint64_t key = programKey(vertexSource, fragmentSource);
+        if(key == p.key) return false;
+
+        // edited stages are compiled outside the shared `shaders` map and
+        // deleted once linked, so every save does not leave two behind
+        GLuint vs = compileShader(GL_VERTEX_SHADER, vertexSource);
+        GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+        GLuint test = vs != 0 && fs != 0 ? linkProgram(vs, fs) : 0;
+        if(test == 0) {
+            glDeleteShader(vs); // 0 is ignored
+            glDeleteShader(fs);
+            std::cerr << "Shader reload failed, keeping the old program: " << p.vertexPath << std::endl;
+            return false;
+        }
+        glDeleteProgram(test);
+
+        // relink the same program object so callers keep a valid name
+        markRetrievable(program);
+        linkProgram(vs, fs, program);
+        glDetachShader(program, vs);
+        glDetachShader(program, fs);
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        saveBinary(program, key);
+
+        bySource.erase(p.key);
+        bySource[key] = program;
+        p.key = key;
+        p.uniforms.clear();
+        std::cout << "Reloaded " << p.vertexPath << " + " << p.fragmentPath << std::endl;
+        return true;
+    }
+
+    // --- binary cache ---
+    // (GL 4.1 / ARB_get_program_binary; compiled out if the loader lacks it,
+    // and skipped at runtime if the driver reports no binary formats)
+
+#ifdef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    template<class Fn> static bool entryPoint(Fn fn) { return fn != nullptr; }
+
+    bool hasBinarySupport() {
+        if(binarySupport < 0) {
+            GLint formats = 0;
+            if(entryPoint(glGetProgramBinary) && entryPoint(glProgramBinary))
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            binarySupport = formats > 0 ? 1 : 0;
+        }
+        return binarySupport == 1;
+    }
+
+    void markRetrievable(GLuint program) {
+        if(hasBinarySupport()) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    std::string binaryPath(uint64_t key) const {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return binaryDir + "/" + name;
+    }
+
+    GLuint loadBinary(uint64_t key) {
+        if(binaryDir.empty() || !hasBinarySupport()) return 0;
+        FILE* f = fopen(binaryPath(key).c_str(), "rb");
+        if(!f) return 0;
+        BinaryHeader header;
+        std::vector<char> data;
+        bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+                  header.magic == BINARY_MAGIC && header.key == key;
+        if(ok) {
+            fseek(f, 0, SEEK_END);
+            long size = ftell(f) - (long)sizeof(header);
+            fseek(f, (long)sizeof(header), SEEK_SET);
+            ok = size > 0;
+            if(ok) {
+                data.resize((size_t)size);
+                ok = fread(data.data(), 1, data.size(), f) == data.size();
+            }
+        }
+        fclose(f);
+        if(!ok) return 0;
+
+        GLuint program = glCreateProgram();
+        glProgramBinary(program, header.format, data.data(), (GLsizei)data.size());
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if(!linked) { // stale binary: compile normally and overwrite it
+            glDeleteProgram(program);
+            return 0;
+        }
+        hits++;
+        return program;
+    }
+
+    void saveBinary(GLuint program, uint64_t key) {
+        if(binaryDir.empty() || !hasBinarySupport()) return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if(length <= 0) return;
+        std::vector<char> data((size_t)length);
+        BinaryHeader header = {BINARY_MAGIC, 0, key};
+        GLenum format = 0;
+        glGetProgramBinary(program, length, nullptr, &format, data.data());
+        header.format = format;
+
+#ifdef _WIN32
+        _mkdir(binaryDir.c_str());
+#else
+        mkdir(binaryDir.c_str(), 0755);
+#endif
+        // write to a temporary name first so a crash never leaves half a file
+        std::string path = binaryPath(key), tmp = path + ".tmp";
+        FILE* f = fopen(tmp.c_str(), "wb");
+        if(!f) return;
+        bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                  fwrite(data.data(), 1, data.size(), f) == data.size();
+        fclose(f);
+        if(ok) {
+            remove(path.c_str());
+            ok = rename(tmp.c_str(), path.c_str()) == 0;
+        }
+        if(!ok) remove(tmp.c_str());
+    }
+#else
+    bool hasBinarySupport() { return false; }
+    void markRetrievable(GLuint) {}
+    GLuint loadBinary(uint64_t) { return 0; }
+    void saveBinary(GLuint, uint64_t) {}
+#endif
+
+    // --- file watching ---
+
+    static time_t modifiedTime(const std::string& path) {
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 ? st.st_mtime : 0;
+    }
+
+    static std::string directoryOf(const std::string& path) {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? "." : path.substr(0, slash);
+    }
+
+    static bool sameFile(const std::string& path, const std::string& dir, const char* name) {
+        size_t slash = path.find_last_of("/\\");
+        std::string base = slash == std::string::npos ? path : path.substr(slash + 1);
+        return base == name && directoryOf(path) == dir;
+    }
+
+    void addWatch(const Program& p) {
+#ifdef __linux__
+        if(inotifyFd < 0 || p.vertexPath.empty()) return;
+        // watch directories, not files: editors often save by renaming a
+        // new file over the old one, which would drop a per-file watch
+        for(const std::string* path : {&p.vertexPath, &p.fragmentPath}) {
+            std::string dir = directoryOf(*path);
+            int wd = inotify_add_watch(inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if(wd >= 0) watchedDirs[wd] = dir;
+        }
+#else
+        (void)p;
+#endif
+    }
+
+    void closeWatch() {
+#ifdef __linux__
+        if(inotifyFd >= 0) close(inotifyFd);
+        inotifyFd = -1;
+        watchedDirs.clear();
+#endif
+    }
+};
+
+// the cache shared by everything drawn in this process's (single) context
+inline ShaderCache& shaderCache() {
+    static ShaderCache cache;
+    return cache;
+}
@@ -0,0 +1,106 @@
+// shader_util.h
+// Shader loading helpers shared by the OpenGL programs.
+//
+// Include this after the OpenGL loader (GLAD / GLEW), it only uses the core
+// GL 2.0+ shader entry points. Compiling and linking are profiler.h zones.
+
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "profiler.h"
+
+/**
+ * @brief Reads a shader file and returns its content as a string.
+ */
+inline std::string readShaderFile(const std::string& filePath) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Could not open shader file: " << filePath << std::endl;
+        return "";
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+/**
+ * @brief Compiles a shader from source.
+ */
+inline GLuint compileShader(GLenum type, const std::string& source) {
+    PROFILE_FUNCTION();
+    GLuint shader = glCreateShader(type);
+    const char* src = source.c_str();
+    glShaderSource(shader, 1, &src, NULL);
+    glCompileShader(shader);
+
+    // Check for compilation errors
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        GLchar infoLog[512];
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::COMPILATION_FAILED\n" << infoLog << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+/**
+ * @brief Links a vertex and a fragment shader into `program` (a new program
+ * if 0). The shaders are left attached; returns 0 on link errors.
+ */
+inline GLuint linkProgram(GLuint vertexShader, GLuint fragmentShader, GLuint program = 0) {
+    PROFILE_FUNCTION();
+    if (program == 0) program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    // Check for linking errors
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        GLchar infoLog[512];
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+/**
+ * @brief Compiles and links a program from in-memory sources.
+ */
+inline GLuint createShaderProgramFromSource(const std::string& vertexSource, const std::string& fragmentSource) {
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = 0;
+    if (vertexShader != 0 && fragmentShader != 0) program = linkProgram(vertexShader, fragmentShader);
+
+    // Clean up shaders as they're now linked into the program
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+/**
+ * @brief Reads, compiles and links a program from two shader files.
+ * Uncached; see shader_cache.h for the shared, cached version.
+ */
+inline GLuint createShaderProgram(const std::string& vertexPath, const std::string& fragmentPath) {
+    PROFILE_FUNCTION();
+    std::string vertexSource = readShaderFile(vertexPath);
+    std::string fragmentSource = readShaderFile(fragmentPath);
+
+    if (vertexSource.empty() || fragmentSource.empty()) return 0;
+
+    return createShaderProgramFromSource(vertexSource, fragmentSource);
+}
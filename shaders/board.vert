@@ -0,0 +1,13 @@
+#version 330 core
+
+// Flat colored triangles: the HUD and other overlay quads
+layout (location = 0) in vec2 vPosition;
+layout (location = 1) in vec4 vColor;
+
+out vec4 color;
+
+void main()
+{
+    gl_Position = vec4(vPosition, 0.0, 1.0);
+    color = vColor;
+}
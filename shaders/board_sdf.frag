@@ -0,0 +1,72 @@
+#version 330 core
+
+// Grid, pieces and winning strike for one cell, all from signed distances
+// in pixels, so every edge gets one pixel of anti-aliasing at any window
+// size; the heatmap, the hint and the game-over shade come in as one
+// flat overlay.
+// Output is premultiplied alpha.
+
+flat in float kind;
+flat in vec4 edgeOffset;
+flat in vec4 overlay;
+in vec2 local;
+
+uniform float gridHalfWidth;   // pixels
+uniform float pieceRadius;     // pixels: O radius, X half extent
+uniform float pieceHalfWidth;  // pixels
+uniform vec4 gridColor;
+uniform vec4 xColor;
+uniform vec4 oColor;
+uniform vec4 strike;           // winning line from .xy to .zw in window pixels
+uniform float strikeHalfWidth; // 0 => no strike
+uniform vec4 strikeColor;
+
+out vec4 FragColor;
+
+float segmentDistance(vec2 p, vec2 a, vec2 b)
+{
+    vec2 pa = p - a, ba = b - a;
+    float h = clamp(dot(pa, ba) / max(dot(ba, ba), 1e-6), 0.0, 1.0);
+    return length(pa - ba * h);
+}
+
+// coverage of a shape whose signed distance (pixels) is d
+float coverage(float d)
+{
+    return clamp(0.5 - d, 0.0, 1.0);
+}
+
+// premultiplied "over"
+vec4 over(vec4 dst, vec3 rgb, float a)
+{
+    return vec4(rgb * a, a) + dst * (1.0 - a);
+}
+
+void main()
+{
+    vec4 c = vec4(0.0);
+
+    // pieces; the X is symmetric, so fold it onto one diagonal
+    if (kind > 0.5) {
+        vec2 p = abs(local);
+        float d = length(p - vec2(min((p.x + p.y) * 0.5, pieceRadius))) - pieceHalfWidth;
+        c = over(c, xColor.rgb, xColor.a * coverage(d));
+    } else if (kind < -0.5) {
+        float d = abs(length(local) - pieceRadius) - pieceHalfWidth;
+        c = over(c, oColor.rgb, oColor.a * coverage(d));
+    }
+
+    // grid: each cell draws its half of the lines on its inner borders
+    vec4 e = edgeOffset + vec4(local.x, -local.x, -local.y, local.y);
+    float edge = min(min(e.x, e.y), min(e.z, e.w));
+    c = over(c, gridColor.rgb, gridColor.a * coverage(edge - gridHalfWidth));
+
+    c = overlay + c * (1.0 - overlay.a);
+
+    if (strikeHalfWidth > 0.0) {
+        float d = segmentDistance(gl_FragCoord.xy, strike.xy, strike.zw) - strikeHalfWidth;
+        c = over(c, strikeColor.rgb, strikeColor.a * coverage(d));
+    }
+
+    FragColor = c;
+}
@@ -0,0 +1,49 @@
+#version 330 core
+
+// One quad per board cell, instanced: the corner of the unit quad (0..1),
+// the cell's contents (0 empty, 1 = X, -1 = O) and its heatmap value (0
+// none, else 1..255 for loss..win). Everything that is the
+// same for the whole cell is worked out here, once per vertex, so the
+// fragment shader only does the distance math.
+layout (location = 0) in vec2 vCorner;
+layout (location = 1) in float iKind;
+layout (location = 2) in float iHeat;
+
+uniform ivec2 gridSize;     // columns, rows
+uniform vec2 cellPixels;    // cell size in framebuffer pixels
+uniform int hintCell;       // -1 for none
+uniform vec4 hintColor;
+uniform float shade;        // game over: black overlay alpha, 0 while playing
+uniform float heatAlpha;
+uniform vec3 heatLoss, heatDraw, heatWin;
+
+flat out float kind;
+flat out vec4 edgeOffset;   // per side: half the cell, or "far away" on the outer border
+flat out vec4 overlay;      // heat, hint and shade combined, premultiplied
+out vec2 local;             // pixels from the cell center, y up
+
+void main()
+{
+    ivec2 cell = ivec2(gl_InstanceID % gridSize.x, gl_InstanceID / gridSize.x); // row 0 at the top
+    kind = iKind;
+    local = (vCorner - 0.5) * cellPixels * vec2(1.0, -1.0);
+
+    // grid lines only on inner borders: left, right, top, bottom
+    vec2 halfSize = cellPixels * 0.5;
+    edgeOffset = vec4(cell.x > 0              ? halfSize.x : 1e6,
+                      cell.x < gridSize.x - 1 ? halfSize.x : 1e6,
+                      cell.y > 0              ? halfSize.y : 1e6,
+                      cell.y < gridSize.y - 1 ? halfSize.y : 1e6);
+
+    // loss -> draw -> win, then the hint and the shade on top of it
+    float v = (iHeat - 1.0) / 254.0;
+    vec3 heatRgb = v < 0.5 ? mix(heatLoss, heatDraw, v * 2.0) : mix(heatDraw, heatWin, v * 2.0 - 1.0);
+    float heat = iHeat > 0.5 ? heatAlpha : 0.0;
+    float hint = gl_InstanceID == hintCell ? hintColor.a : 0.0;
+    vec4 o = vec4(heatRgb * heat, heat);
+    o = vec4(hintColor.rgb * hint, hint) + o * (1.0 - hint);
+    overlay = o * (1.0 - shade) + vec4(0.0, 0.0, 0.0, shade);
+
+    vec2 ndc = vec2(-1.0, 1.0) + (vec2(cell) + vCorner) * vec2(2.0, -2.0) / vec2(gridSize);
+    gl_Position = vec4(ndc, 0.0, 1.0);
+}
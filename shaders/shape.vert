@@ -0,0 +1,31 @@
+#version 330 core
+
+// Unit mesh vertex from shapes.h: direction on the unit circle, radial flag, shade
+layout (location = 0) in vec4 vUnit;
+
+// Per-instance data (one entry per shape in the instance buffer)
+layout (location = 1) in vec4 iTransform;   // translation.xy, scale.xy
+layout (location = 2) in vec4 iParams;      // rotation (radians), innerRadius, gradient, unused
+layout (location = 3) in vec4 iInnerColor;  // at the center / inner edge
+layout (location = 4) in vec4 iOuterColor;  // at the outer edge
+
+uniform mat4 model_view_projection;
+
+out vec4 color;
+
+void main()
+{
+    // rings pull their inner vertices in to innerRadius, discs to the center
+    float r = mix(iParams.y, 1.0, vUnit.z);
+    vec2 local = iTransform.zw * vUnit.xy * r;
+
+    float c = cos(iParams.x), s = sin(iParams.x);
+    vec2 position = iTransform.xy + vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+    gl_Position = model_view_projection * vec4(position, 0.0, 1.0);
+
+    // gradient darkens the outer edge towards -x (0.25 => 0.5 .. 1.0)
+    float g = iParams.z;
+    vec4 rim = vec4(iOuterColor.rgb * (1.0 - g + g * vUnit.x), iOuterColor.a);
+    color = mix(iInnerColor, rim, vUnit.z);
+    color.rgb *= vUnit.w;
+}
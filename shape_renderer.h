@@ -0,0 +1,197 @@
+// shape_renderer.h
+// Instanced OpenGL renderer for the shape library (shapes.h / shapes.cpp).
+//
+// Each mesh type (disc, ring, triangle, square) is tessellated once into a
+// single static VBO. Shapes are submitted as ShapeInstance records
+// (translation, scale, rotation, colors) into a separate instance buffer,
+// and each mesh type is drawn with one glDrawArraysInstanced call, so the
+// number of draw calls does not grow with the number of shapes.
+// drawUnbatched() issues one draw per shape instead, for comparison.
+//
+// Include this after the OpenGL loader.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "profiler.h"
+#include "shapes.h"
+#include "shader_cache.h"
+
+enum ShapeMesh {
+    SHAPE_DISC,     // circles and ellipses
+    SHAPE_RING,
+    SHAPE_TRIANGLE, // corner up
+    SHAPE_SQUARE,   // axis aligned, shaded corners
+    SHAPE_MESH_COUNT
+};
+
+// per-instance data, matches the attributes of shaders/shape.vert
+struct ShapeInstance {
+    float translation[2] = {0.0f, 0.0f};
+    float scale[2] = {1.0f, 1.0f};   // x / y radius
+    float rotation = 0.0f;           // radians
+    float innerRadius = 0.0f;        // rings only: fraction of the radius
+    float gradient = 0.0f;           // darken the outer edge towards -x
+    float unused = 0.0f;
+    float innerColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    float outerColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+};
+
+class ShapeRenderer {
+public:
+    bool init(int segments,
+              const std::string& vertexPath = "shaders/shape.vert",
+              const std::string& fragmentPath = "shaders/shape.frag") {
+        PROFILE_ZONE("ShapeRenderer::init");
+        program = shaderCache().load(vertexPath, fragmentPath);
+        if(program == 0) return false;
+
+        // all meshes in one static buffer, sized exactly
+        // square corners: top-right, top-left, bottom-left, bottom-right
+        const float squareShades[4] = {1.0f, 0.8f, 0.6f, 0.4f};
+        std::vector<UnitVertex> mesh;
+        mesh.reserve(discVertexCount(segments) + ringVertexCount(segments) +
+                     polygonVertexCount(3) + polygonVertexCount(4));
+        meshes[SHAPE_DISC]     = {GL_TRIANGLE_FAN,   (GLint)appendDisc(mesh, segments), (GLsizei)discVertexCount(segments)};
+        meshes[SHAPE_RING]     = {GL_TRIANGLE_STRIP, (GLint)appendRing(mesh, segments), (GLsizei)ringVertexCount(segments)};
+        meshes[SHAPE_TRIANGLE] = {GL_TRIANGLES, (GLint)appendPolygon(mesh, 3, (float)M_PI / 2.0f), (GLsizei)polygonVertexCount(3)};
+        meshes[SHAPE_SQUARE]   = {GL_TRIANGLES, (GLint)appendPolygon(mesh, 4, (float)M_PI / 4.0f, squareShades), (GLsizei)polygonVertexCount(4)};
+
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &meshVBO);
+        glGenBuffers(1, &instanceVBO);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+        glBufferData(GL_ARRAY_BUFFER, mesh.size() * sizeof(UnitVertex), mesh.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(UnitVertex), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for(GLuint a=1;a<=4;a++){
+            glEnableVertexAttribArray(a);
+            glVertexAttribDivisor(a, 1);
+        }
+        pointInstances(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        return true;
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &meshVBO);
+        glDeleteBuffers(1, &instanceVBO);
+        glDeleteVertexArrays(1, &vao);
+        program = 0; // owned by shaderCache()
+    }
+
+    // reserve CPU storage for this many shapes of one mesh type
+    void reserve(ShapeMesh mesh, size_t count) { instances[mesh].reserve(count); }
+
+    void clear() {
+        for(auto& list : instances) list.clear();
+        dirty = true;
+    }
+
+    void add(ShapeMesh mesh, const ShapeInstance& inst) {
+        instances[mesh].push_back(inst);
+        dirty = true;
+    }
+
+    // direct access for animating instances in place; call markDirty() after
+    std::vector<ShapeInstance>& list(ShapeMesh mesh) { return instances[mesh]; }
+    void markDirty() { dirty = true; }
+
+    size_t instanceCount() const {
+        size_t n = 0;
+        for(const auto& list : instances) n += list.size();
+        return n;
+    }
+
+    // draw calls issued by the last draw()/drawUnbatched()
+    size_t drawCalls() const { return lastDrawCalls; }
+
+    // one instanced draw per mesh type
+    void draw(const GLfloat* mvp) {
+        begin(mvp);
+        for(int m=0;m<SHAPE_MESH_COUNT;m++){
+            if(instances[m].empty()) continue;
+            pointInstances(offsets[m]);
+            glDrawArraysInstanced(meshes[m].mode, meshes[m].first, meshes[m].count, (GLsizei)instances[m].size());
+            lastDrawCalls++;
+        }
+        end();
+    }
+
+    // one draw per shape, same output as draw(); for measuring call overhead
+    void drawUnbatched(const GLfloat* mvp) {
+        begin(mvp);
+        for(int m=0;m<SHAPE_MESH_COUNT;m++){
+            for(size_t i=0;i<instances[m].size();i++){
+                pointInstances(offsets[m] + i);
+                glDrawArraysInstanced(meshes[m].mode, meshes[m].first, meshes[m].count, 1);
+                lastDrawCalls++;
+            }
+        }
+        end();
+    }
+
+private:
+    struct MeshRange {
+        GLenum mode;
+        GLint first;
+        GLsizei count;
+    };
+
+    GLuint program = 0, vao = 0, meshVBO = 0, instanceVBO = 0;
+    MeshRange meshes[SHAPE_MESH_COUNT] = {};
+    std::vector<ShapeInstance> instances[SHAPE_MESH_COUNT];
+    size_t offsets[SHAPE_MESH_COUNT] = {}; // first instance of each mesh in instanceVBO
+    size_t capacity = 0;                   // instances allocated in instanceVBO
+    bool dirty = true;
+    size_t lastDrawCalls = 0;
+
+    void begin(const GLfloat* mvp) {
+        glUseProgram(program);
+        glUniformMatrix4fv(shaderCache().uniform(program, "model_view_projection"), 1, GL_FALSE, mvp);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        if(dirty) upload();
+        lastDrawCalls = 0;
+    }
+
+    void end() {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        glUseProgram(0);
+    }
+
+    // stream all instance lists into instanceVBO back to back (bound by begin)
+    void upload() {
+        PROFILE_ZONE("ShapeRenderer::upload");
+        size_t total = instanceCount();
+        if(total > capacity) capacity = total;
+        // (re)allocating also orphans the old storage, so the driver doesn't
+        // wait for last frame's draws before we overwrite it
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(ShapeInstance), NULL, GL_STREAM_DRAW);
+        size_t at = 0;
+        for(int m=0;m<SHAPE_MESH_COUNT;m++){
+            offsets[m] = at;
+            if(!instances[m].empty())
+                glBufferSubData(GL_ARRAY_BUFFER, at * sizeof(ShapeInstance),
+                                instances[m].size() * sizeof(ShapeInstance), instances[m].data());
+            at += instances[m].size();
+        }
+        dirty = false;
+    }
+
+    // GL 3.3 has no base instance, so move the instance attributes instead
+    void pointInstances(size_t first) {
+        const size_t stride = sizeof(ShapeInstance);
+        const char* base = (const char*)0 + first * stride;
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, base + offsetof(ShapeInstance, translation));
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, base + offsetof(ShapeInstance, rotation));
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, base + offsetof(ShapeInstance, innerColor));
+        glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, base + offsetof(ShapeInstance, outerColor));
+    }
+};
@@ -0,0 +1,112 @@
+// shape_scene.h
+// The modern_gl_a1 picture as ShapeRenderer instances, the random scene
+// used by `modern_gl_a1 --stress N`, and drawShapeFrame(), the frame
+// modern_gl_a1's display() draws.
+//
+// Shared by modern_gl_a1.cpp, render_bench.cpp and golden_check.cpp, so
+// the tools draw exactly what the program shows. Include this after the
+// OpenGL loader.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "shape_renderer.h"
+
+// Circle: center (0.0, 0.5), radius 0.2. Solid red center; the rim varies R
+// from 0.5 (dim) to 1.0 (bright) and back around the circle.
+inline void addCircle(ShapeRenderer& shapes) {
+    ShapeInstance circle;
+    circle.translation[0] = 0.0f;
+    circle.translation[1] = 0.5f;
+    circle.scale[0] = circle.scale[1] = 0.2f;
+    const float red[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+    std::copy(red, red + 4, circle.innerColor);
+    std::copy(red, red + 4, circle.outerColor);
+    circle.gradient = 0.25f;
+    shapes.add(SHAPE_DISC, circle);
+}
+
+// Ellipse: center (0.5, -0.5), radiusX 0.2, radiusY 0.12; yellow center,
+// orange rim.
+inline void addEllipse(ShapeRenderer& shapes) {
+    ShapeInstance ellipse;
+    ellipse.translation[0] = 0.5f;
+    ellipse.translation[1] = -0.5f;
+    ellipse.scale[0] = 0.2f;
+    ellipse.scale[1] = 0.12f;
+    const float yellow[4] = {1.0f, 1.0f, 0.0f, 1.0f};
+    const float orange[4] = {1.0f, 0.6f, 0.0f, 1.0f};
+    std::copy(yellow, yellow + 4, ellipse.innerColor);
+    std::copy(orange, orange + 4, ellipse.outerColor);
+    shapes.add(SHAPE_DISC, ellipse);
+}
+
+// Square: center (-0.5, -0.5), side 0.4, corners shaded white to dark gray.
+// The unit square mesh has its corners on the unit circle.
+inline void addSquare(ShapeRenderer& shapes) {
+    ShapeInstance square;
+    square.translation[0] = -0.5f;
+    square.translation[1] = -0.5f;
+    square.scale[0] = square.scale[1] = 0.2f * (float)M_SQRT2;
+    shapes.add(SHAPE_SQUARE, square);
+}
+
+// Triangle: center (-0.5, 0.5), size 0.3, solid green.
+inline void addTriangle(ShapeRenderer& shapes) {
+    ShapeInstance triangle;
+    triangle.translation[0] = -0.5f;
+    triangle.translation[1] = 0.5f;
+    triangle.scale[0] = triangle.scale[1] = 0.3f;
+    const float green[4] = {0.0f, 1.0f, 0.0f, 1.0f};
+    std::copy(green, green + 4, triangle.innerColor);
+    std::copy(green, green + 4, triangle.outerColor);
+    shapes.add(SHAPE_TRIANGLE, triangle);
+}
+
+// the modern_gl_a1 picture: circle, ellipse, square and triangle
+inline void addDefaultShapes(ShapeRenderer& shapes) {
+    addCircle(shapes);
+    addEllipse(shapes);
+    addSquare(shapes);
+    addTriangle(shapes);
+}
+
+// `count` random shapes of all four mesh types, sized so they roughly tile
+// the screen. Always the same scene for the same count.
+inline void addStressShapes(ShapeRenderer& shapes, int count) {
+    for(int m=0;m<SHAPE_MESH_COUNT;m++) shapes.reserve((ShapeMesh)m, count / SHAPE_MESH_COUNT + 1);
+
+    float size = 1.5f / std::sqrt((float)count);
+    unsigned int seed = 12345;
+    auto random01 = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (seed >> 8) / 16777216.0f;
+    };
+
+    for(int i=0;i<count;i++){
+        ShapeInstance inst;
+        inst.translation[0] = random01() * 2.0f - 1.0f;
+        inst.translation[1] = random01() * 2.0f - 1.0f;
+        inst.scale[0] = size * (0.5f + random01());
+        inst.scale[1] = size * (0.5f + random01());
+        inst.rotation = random01() * 2.0f * (float)M_PI;
+        inst.innerRadius = 0.6f;
+        const float color[4] = {random01(), random01(), random01(), 1.0f};
+        std::copy(color, color + 4, inst.innerColor);
+        std::copy(color, color + 4, inst.outerColor);
+        inst.gradient = 0.25f;
+        shapes.add((ShapeMesh)(i % SHAPE_MESH_COUNT), inst);
+    }
+}
+
+const float SHAPE_BACKGROUND[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+
+// one frame of modern_gl_a1: background, then every instance under `mvp`
+inline void drawShapeFrame(ShapeRenderer& shapes, const GLfloat* mvp, bool unbatched = false) {
+    glClearColor(SHAPE_BACKGROUND[0], SHAPE_BACKGROUND[1], SHAPE_BACKGROUND[2], SHAPE_BACKGROUND[3]);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if(unbatched) shapes.drawUnbatched(mvp);
+    else shapes.draw(mvp);
+}
@@ -0,0 +1,68 @@
+// shapes.cpp
+// Cached unit-circle tessellation, see shapes.h.
+
+#include "shapes.h"
+
+#include <cmath>
+#include <map>
+#include <mutex>
+
+const std::vector<float>& unitCircle(int segments) {
+    static std::map<int, std::vector<float>> cache;
+    static std::mutex cacheMutex;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(segments);
+    if(it != cache.end()) return it->second;
+
+    std::vector<float>& pts = cache[segments]; // map nodes never move
+    pts.reserve(((size_t)segments + 1) * 2);
+    for(int i=0;i<segments;i++){
+        double a = (double)i / segments * 2.0 * M_PI;
+        pts.push_back((float)cos(a));
+        pts.push_back((float)sin(a));
+    }
+    // close the loop exactly
+    pts.push_back(pts[0]);
+    pts.push_back(pts[1]);
+    return pts;
+}
+
+size_t appendDisc(std::vector<UnitVertex>& out, int segments) {
+    const std::vector<float>& c = unitCircle(segments);
+    size_t first = out.size();
+    out.reserve(first + discVertexCount(segments));
+    out.push_back({{0.0f, 0.0f}, 0.0f, 1.0f});
+    for(int i=0;i<=segments;i++) out.push_back({{c[2*i], c[2*i+1]}, 1.0f, 1.0f});
+    return first;
+}
+
+size_t appendRing(std::vector<UnitVertex>& out, int segments) {
+    const std::vector<float>& c = unitCircle(segments);
+    size_t first = out.size();
+    out.reserve(first + ringVertexCount(segments));
+    for(int i=0;i<=segments;i++){
+        out.push_back({{c[2*i], c[2*i+1]}, 0.0f, 1.0f});
+        out.push_back({{c[2*i], c[2*i+1]}, 1.0f, 1.0f});
+    }
+    return first;
+}
+
+size_t appendPolygon(std::vector<UnitVertex>& out, int sides, float startAngle, const float* shades) {
+    const std::vector<float>& c = unitCircle(sides);
+    float cs = cosf(startAngle), sn = sinf(startAngle);
+    std::vector<UnitVertex> corners;
+    corners.reserve(sides);
+    for(int i=0;i<sides;i++){
+        float x = c[2*i], y = c[2*i+1];
+        corners.push_back({{x*cs - y*sn, x*sn + y*cs}, 1.0f, shades ? shades[i] : 1.0f});
+    }
+    size_t first = out.size();
+    out.reserve(first + polygonVertexCount(sides));
+    for(int i=1;i+1<sides;i++){
+        out.push_back(corners[0]);
+        out.push_back(corners[i]);
+        out.push_back(corners[i+1]);
+    }
+    return first;
+}
@@ -0,0 +1,47 @@
+// shapes.h
+// Reusable tessellation for round primitives (circles, ellipses, rings).
+//
+// The unit circle is computed once per segment count and cached, so no
+// shape ever calls cos/sin again. Meshes are built in "unit" form: each
+// vertex stores a direction on the unit circle and a radial flag, and the
+// vertex shader (shaders/shape.vert) turns that into the final position:
+//
+//     position = center + radii * dir * mix(innerRadius, 1.0, radial)
+//
+// so one disc mesh draws every circle and ellipse, and one ring mesh every
+// ring, by changing only the per-shape transform.
+//
+// No OpenGL dependency; the GL side lives in shape_renderer.h.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct UnitVertex {
+    float dir[2];        // point on the unit circle, (0,0) for a fan center
+    float radial;        // 0 = inner edge / center, 1 = outer edge
+    float shade = 1.0f;  // per-vertex brightness (e.g. shaded polygon corners)
+};
+
+// segments+1 points (cos, sin) around the unit circle, the last point equal
+// to the first. Computed on first use, then returned from the cache.
+const std::vector<float>& unitCircle(int segments);
+
+// Filled disc as a GL_TRIANGLE_FAN: center + segments+1 rim vertices.
+// Returns the index of the first vertex written.
+size_t appendDisc(std::vector<UnitVertex>& out, int segments);
+
+// Ring as a GL_TRIANGLE_STRIP: (segments+1) * 2 vertices, inner/outer pairs.
+size_t appendRing(std::vector<UnitVertex>& out, int segments);
+
+// Regular polygon with `sides` corners on the unit circle, the first at
+// `startAngle` radians, as a GL_TRIANGLES fan from corner 0:
+// (sides - 2) * 3 vertices. `shades` optionally gives one value per corner.
+size_t appendPolygon(std::vector<UnitVertex>& out, int sides, float startAngle,
+                     const float* shades = nullptr);
+
+// vertex counts, so callers can reserve storage up front
+inline size_t discVertexCount(int segments) { return (size_t)segments + 2; }
+inline size_t ringVertexCount(int segments) { return ((size_t)segments + 1) * 2; }
+inline size_t polygonVertexCount(int sides) { return ((size_t)sides - 2) * 3; }
@@ -0,0 +1,175 @@
+// simulator.cpp
+// Headless batch self-play for Three-in-a-Row.
+//
+// Plays N games between two policies using only the game rules
+// (game_state.h / outcome_table.h, no GLFW or OpenGL) and reports the
+// win/draw statistics and the throughput in games per second.
+//
+// Games are split into one shard per thread; every thread has its own Rng
+// and its own counters, which are only added together after join().
+// --record appends every game to a record file (game_record.h); each
+// thread fills its own block and only takes the file lock to append it.
+//
+// Usage: simulator [--games N] [--threads T] [--x POLICY] [--o POLICY] [--seed S] [--record FILE]
+//   POLICY is random, greedy or solver (default: random vs random)
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game_record.h"
+#include "game_state.h"
+#include "outcome_table.h"
+#include "rng.h"
+
+enum Policy { POLICY_RANDOM, POLICY_GREEDY, POLICY_SOLVER };
+
+const char* policyName(Policy p) {
+    switch(p) {
+        case POLICY_GREEDY: return "greedy";
+        case POLICY_SOLVER: return "solver";
+        default:            return "random";
+    }
+}
+
+bool parsePolicy(const char* s, Policy& out) {
+    if(strcmp(s, "random") == 0) out = POLICY_RANDOM;
+    else if(strcmp(s, "greedy") == 0) out = POLICY_GREEDY;
+    else if(strcmp(s, "solver") == 0) out = POLICY_SOLVER;
+    else return false;
+    return true;
+}
+
+// uniform random empty cell
+int randomMove(const GameState& s, Rng& rng) {
+    uint32_t empty = s.emptyCells();
+    int pick = (int)rng.below((uint32_t)__builtin_popcount(empty));
+    while(pick--) empty &= empty - 1; // drop the lowest set bits
+    return __builtin_ctz(empty);
+}
+
+// complete a line if possible, otherwise block one, otherwise random
+int greedyMove(const GameState& s, Rng& rng) {
+    uint16_t mine = s.sideToMove() == 1 ? s.x : s.o;
+    uint16_t theirs = s.sideToMove() == 1 ? s.o : s.x;
+    uint16_t empty = s.emptyCells();
+    int block = -1;
+    for(uint16_t m = empty; m; m &= m - 1) {
+        int i = __builtin_ctz(m);
+        uint16_t bit = (uint16_t)(1u << i);
+        if(WIN_LINE_TABLE.line[mine | bit] >= 0) return i;
+        if(block < 0 && WIN_LINE_TABLE.line[theirs | bit] >= 0) block = i;
+    }
+    return block >= 0 ? block : randomMove(s, rng);
+}
+
+int chooseMove(Policy p, const GameState& s, Rng& rng) {
+    switch(p) {
+        case POLICY_GREEDY: return greedyMove(s, rng);
+        case POLICY_SOLVER: return bestMoveFromTable(s);
+        default:            return randomMove(s, rng);
+    }
+}
+
+struct Stats {
+    uint64_t games = 0;
+    uint64_t xWins = 0;
+    uint64_t oWins = 0;
+    uint64_t draws = 0;
+    uint64_t moves = 0;
+
+    void add(const Stats& o) {
+        games += o.games; xWins += o.xWins; oWins += o.oWins;
+        draws += o.draws; moves += o.moves;
+    }
+};
+
+void playGames(uint64_t count, Policy xPolicy, Policy oPolicy, uint64_t seed, GameRecordWriter* record, Stats& out) {
+    Rng rng(seed);
+    Stats st;
+    GameRecordBlock block;
+    int moves[9];
+    for(uint64_t g=0;g<count;g++){
+        GameState s;
+        int side = 1;
+        int n = 0;
+        while(s.result() == 0) {
+            int idx = chooseMove(side == 1 ? xPolicy : oPolicy, s, rng);
+            s.play(idx, side);
+            moves[n++] = idx;
+            side = -side;
+        }
+        int r = s.result();
+        if(record) {
+            block.add(moves, n, r);
+            if(block.full()) record->append(block);
+        }
+        if(r == 1) st.xWins++;
+        else if(r == -1) st.oWins++;
+        else st.draws++;
+        st.moves += s.moveCount();
+        st.games++;
+    }
+    if(record) record->append(block);
+    out = st;
+}
+
+int main(int argc, char** argv) {
+    uint64_t games = 1000000;
+    int threads = (int)std::thread::hardware_concurrency();
+    Policy xPolicy = POLICY_RANDOM, oPolicy = POLICY_RANDOM;
+    uint64_t seed = 1;
+    std::string recordPath;
+
+    for(int i=1;i<argc;i++){
+        std::string arg = argv[i];
+        bool hasValue = i+1 < argc;
+        if(arg == "--games" && hasValue) games = strtoull(argv[++i], NULL, 10);
+        else if(arg == "--threads" && hasValue) threads = atoi(argv[++i]);
+        else if(arg == "--seed" && hasValue) seed = strtoull(argv[++i], NULL, 10);
+        else if(arg == "--x" && hasValue && parsePolicy(argv[i+1], xPolicy)) i++;
+        else if(arg == "--o" && hasValue && parsePolicy(argv[i+1], oPolicy)) i++;
+        else if(arg == "--record" && hasValue) recordPath = argv[++i];
+        else {
+            fprintf(stderr, "Usage: %s [--games N] [--threads T] [--x POLICY] [--o POLICY] [--seed S] [--record FILE]\n"
+                            "  POLICY: random | greedy | solver\n", argv[0]);
+            return 1;
+        }
+    }
+    if(threads < 1) threads = 1;
+
+    GameRecordWriter record;
+    if(!recordPath.empty() && !record.open(recordPath, RecordBoard())) {
+        fprintf(stderr, "cannot open %s\n", recordPath.c_str());
+        return 1;
+    }
+
+    std::vector<Stats> shards(threads);
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for(int t=0;t<threads;t++){
+        uint64_t count = games / threads + ((uint64_t)t < games % threads ? 1 : 0);
+        pool.emplace_back(playGames, count, xPolicy, oPolicy, seed + t,
+                          record.isOpen() ? &record : nullptr, std::ref(shards[t]));
+    }
+    for(auto& th : pool) th.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Stats total;
+    for(const Stats& s : shards) total.add(s);
+
+    double n = total.games ? (double)total.games : 1.0;
+    printf("X=%s vs O=%s, %llu games on %d threads\n", policyName(xPolicy), policyName(oPolicy),
+           (unsigned long long)total.games, threads);
+    printf("  X wins: %12llu (%6.2f%%)\n", (unsigned long long)total.xWins, 100.0 * total.xWins / n);
+    printf("  O wins: %12llu (%6.2f%%)\n", (unsigned long long)total.oWins, 100.0 * total.oWins / n);
+    printf("  draws:  %12llu (%6.2f%%)\n", (unsigned long long)total.draws, 100.0 * total.draws / n);
+    printf("  avg moves per game: %.2f\n", total.moves / n);
+    printf("  %.3fs, %.0f games/s, %.0f moves/s\n", seconds, total.games / seconds, total.moves / seconds);
+    return 0;
+}
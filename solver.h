@@ -0,0 +1,138 @@
+// solver.h
+// Perfect-play negamax solver for Three-in-a-Row.
+//
+// Alpha-beta negamax over GameState with a transposition table. The table is
+// indexed by a canonical key: the smallest base-3 encoding of the position
+// over the 8 rotations/reflections of the grid, so symmetric positions share
+// one entry. The table lives as long as the Solver, so the ~5,478 legal
+// positions are searched once and every later query is a handful of lookups.
+//
+// Scores are from the side to move: a win that ends the game at ply n is
+// worth 10 - n (faster wins score higher), a draw is 0.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "game_state.h"
+
+// cell permutations for the 8 symmetries of the 3x3 grid: SYMMETRIES[s][i]
+// is where cell i ends up under symmetry s
+constexpr int SYMMETRIES[8][9] = {
+    {0,1,2,3,4,5,6,7,8}, // identity
+    {2,5,8,1,4,7,0,3,6}, // rotate 90
+    {8,7,6,5,4,3,2,1,0}, // rotate 180
+    {6,3,0,7,4,1,8,5,2}, // rotate 270
+    {2,1,0,5,4,3,8,7,6}, // mirror left-right
+    {6,7,8,3,4,5,0,1,2}, // mirror top-bottom
+    {0,3,6,1,4,7,2,5,8}, // transpose
+    {8,5,2,7,4,1,6,3,0}  // anti-transpose
+};
+
+// 9-bit mask after each symmetry
+struct SymmetryTables {
+    uint16_t mask[8][512];
+};
+
+constexpr SymmetryTables makeSymmetryTables() {
+    SymmetryTables t{};
+    for(int m=0;m<512;m++){
+        for(int i=0;i<9;i++){
+            if(!(m >> i & 1)) continue;
+            for(int s=0;s<8;s++) t.mask[s][m] |= (uint16_t)(1u << SYMMETRIES[s][i]);
+        }
+    }
+    return t;
+}
+
+inline constexpr SymmetryTables SYMMETRY_TABLES = makeSymmetryTables();
+
+// smallest encoding over the 8 symmetric images of the position
+inline int canonicalIndex(const GameState& s) {
+    int best = NUM_POSITIONS;
+    for(int k=0;k<8;k++){
+        int idx = ternaryIndex(SYMMETRY_TABLES.mask[k][s.x], SYMMETRY_TABLES.mask[k][s.o]);
+        if(idx < best) best = idx;
+    }
+    return best;
+}
+
+class Solver {
+public:
+    Solver() { clear(); }
+
+    void clear() {
+        memset(table, 0, sizeof(table));
+        nodes = 0;
+    }
+
+    // exact score of the position for the side to move
+    int evaluate(const GameState& s) {
+        return negamax(s, -SCORE_INF, SCORE_INF);
+    }
+
+    // best cell for the side to move, -1 if the game is already over
+    int bestMove(const GameState& s) {
+        if(s.result() != 0) return -1;
+        int side = s.sideToMove();
+        int best = -1, bestScore = -SCORE_INF;
+        for(int i : MOVE_ORDER) {
+            if(!s.isEmpty(i)) continue;
+            GameState child = s;
+            child.play(i, side);
+            int score = -evaluate(child);
+            if(score > bestScore) { bestScore = score; best = i; }
+        }
+        return best;
+    }
+
+    // number of nodes visited since the last clear()
+    uint64_t nodesSearched() const { return nodes; }
+
+private:
+    enum : uint8_t { EMPTY = 0, EXACT, LOWER, UPPER };
+
+    struct Entry {
+        int8_t score;
+        uint8_t flag;
+    };
+
+    static constexpr int SCORE_INF = 100;
+
+    Entry table[NUM_POSITIONS];
+    uint64_t nodes = 0;
+
+    int negamax(const GameState& s, int alpha, int beta) {
+        nodes++;
+        int n = s.moveCount();
+        // the previous player may have just completed a line
+        if(s.winner() != 0) return -(10 - n);
+        if(n == 9) return 0;
+
+        Entry& e = table[canonicalIndex(s)];
+        if(e.flag == EXACT) return e.score;
+        if(e.flag == LOWER && e.score > alpha) alpha = e.score;
+        else if(e.flag == UPPER && e.score < beta) beta = e.score;
+        if(e.flag != EMPTY && alpha >= beta) return e.score;
+
+        int alphaOrig = alpha;
+        int side = s.sideToMove();
+        int best = -SCORE_INF;
+        for(int i : MOVE_ORDER) {
+            if(!s.isEmpty(i)) continue;
+            GameState child = s;
+            child.play(i, side);
+            int score = -negamax(child, -beta, -alpha);
+            if(score > best) best = score;
+            if(best > alpha) alpha = best;
+            if(alpha >= beta) break;
+        }
+
+        e.score = (int8_t)best;
+        if(best <= alphaOrig) e.flag = UPPER;
+        else if(best >= beta) e.flag = LOWER;
+        else e.flag = EXACT;
+        return best;
+    }
+};